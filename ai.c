@@ -1,13 +1,14 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "ai.h"
 
 bool make_weighted_shot(player_t* target) {
     // Generate probability grid for state
-    grid_t prob_grid = {.width = target->grid->width, .height = target->grid->height};
-    allocate_grid_data(&prob_grid, false);
+    prob_grid_t prob_grid = {.width = target->grid->width, .height = target->grid->height};
+    allocate_prob_grid(&prob_grid);
     gen_probability_grid(target->grid, &prob_grid, target->ships, target->ship_count);
 
     // Determine optimal shot
@@ -17,88 +18,107 @@ bool make_weighted_shot(player_t* target) {
         // Shoot at the highest probability square (randomly if multiple have max)
         uint16_t ongoing = 0;
         uint16_t shot = 1 + rand() % occurrence;
-        for (int8_t x = 0; x < target->grid->width; x++) {
-            for (int8_t y = 0; y < target->grid->height; y++) {
-                if (get_grid_data(&prob_grid, x, y) == max) {
+        int16_t* weight = prob_grid.weights;
+        for (int8_t y = 0; y < target->grid->height; y++) {
+            for (int8_t x = 0; x < target->grid->width; x++, weight++) {
+                if (*weight == max) {
                     ongoing++;
                 }
                 if (ongoing == shot) {
                     shoot_pos(target, x, y);
                     target->last_x = x;
                     target->last_y = y;
-                    free(prob_grid.data);
+                    free(prob_grid.weights);
                     return true;
                 }
             }
         }
     }
-    free(prob_grid.data);
+    free(prob_grid.weights);
     return false;
 }
 
 
-uint16_t get_max_probability(grid_t* prob_grid, int16_t* max_val) {
+void allocate_prob_grid(prob_grid_t* prob_grid) {
+    prob_grid->weights = malloc(prob_grid->width * prob_grid->height * sizeof(int16_t));
+}
+
+
+uint16_t get_max_probability(prob_grid_t* prob_grid, int16_t* max_val) {
     uint16_t max_occurences = 0;
-    *max_val = BLOCKED_POS;
+    *max_val = -1; // Below any weight
 
-    for (int8_t x = 0; x < prob_grid->width; x++) {
-        for (int8_t y = 0; y < prob_grid->height; y++) {
-            int16_t data = get_grid_data(prob_grid, x, y);
-            if (data > *max_val) {
-                *max_val = data;
-                max_occurences = 1;
-            } else if (data == *max_val) {
-                max_occurences++;
-            }
+    // Weights are visited in storage order
+    int16_t* weight = prob_grid->weights;
+    for (uint16_t remaining = prob_grid->width * prob_grid->height; remaining > 0; remaining--) {
+        int16_t data = *weight++;
+        if (data > *max_val) {
+            *max_val = data;
+            max_occurences = 1;
+        } else if (data == *max_val) {
+            max_occurences++;
         }
     }
     return max_occurences;
 }
 
 
-uint16_t gen_probability_grid(grid_t* target_grid, grid_t* prob_grid, ship_t ships[], uint8_t ship_count) {
+uint16_t gen_probability_grid(grid_t* target_grid, prob_grid_t* prob_grid, ship_t ships[], uint8_t ship_count) {
     // Initialise
-    zero_grid_data(prob_grid);
+    memset(prob_grid->weights, 0, prob_grid->width * prob_grid->height * sizeof(int16_t));
     uint16_t grid_weight = 0;
+    uint8_t width = target_grid->width;
+    uint8_t height = target_grid->height;
+
+    // Ships cannot pass through misses or confirmed destroys (or next to them under RuleNoTouch)
+    bitboard_t blocked, excluded, hits, unshot;
+    excluded = target_grid->destroyed;
+    if (placement_rule == RuleNoTouch) {
+        bb_dilate(&excluded, width, height, &excluded);
+    }
+    get_miss_bitboard(target_grid, &blocked);
+    for (uint8_t y = 0; y < height; y++) {
+        blocked.rows[y] |= excluded.rows[y];
+    }
+    get_hit_bitboard(target_grid, &hits);
+    bb_and_not(&hits, &target_grid->destroyed, height, &hits);
+    get_unshot_bitboard(target_grid, &unshot);
 
     // Attempt placement for all ships that are alive
+    avail_masks_t avail;
     for (uint8_t idx_ship = 0; idx_ship < ship_count; idx_ship++) {
         ship_t ship = ships[idx_ship];
         if (is_ship_destroyed(&ship)) {
             continue;
         }
-        // Attempt placement in all configurations
-        for (ship.x = 0; ship.x < target_grid->width; ship.x++) {
-            for (ship.y = 0; ship.y < target_grid->height; ship.y++) {
-                for (ship.dir = D_North; ship.dir <= D_West; ship.dir++) {
-                    uint8_t weight = 1;
-                    bool valid = true;
-                    // Validate that ship is placeable
-                    int8_t x = ship.x;
-                    int8_t y = ship.y;
-                    for (uint8_t i = 0; i < ship.length; i++) {
-                        int16_t data = get_grid_data(target_grid, x, y);
-                        // Not valid if off grid or through miss or through confirmed destroy
-                        if (data == BLOCKED_POS || IS_MISS(data) || data & DESTROY_POS) {
-                            valid = false;
-                            break;
-                        } else if (IS_HIT(data)) {
-                            weight *= 10;
-                        }
-                        move_x_y(&x, &y, ship.dir);
+        // Every available placement is valid, so only its covered rows need visiting
+        gen_availability_masks(&blocked, width, height, ship.length, &avail);
+        for (dir_t dir = D_North; dir <= D_West; dir++) {
+            ship.dir = dir;
+            bitboard_t origins = avail.dir[dir];
+            uint8_t origin_x, origin_y = 0;
+            while (bb_next(&origins, height, &origin_x, &origin_y)) {
+                ship.x = origin_x;
+                ship.y = origin_y;
+                int8_t top_x, top_y;
+                bb_row_t mask = get_ship_row_mask(&ship, &top_x, &top_y);
+                uint8_t rows = is_ship_horizontal(&ship) ? 1 : ship.length;
+
+                // Weight placements through previous (undestroyed) hits higher
+                uint8_t weight = 1;
+                for (uint8_t i = 0; i < rows; i++) {
+                    for (uint8_t n = bb_row_popcount(hits.rows[top_y + i] & mask); n > 0; n--) {
+                        weight *= 10;
                     }
-                    if (valid) {
-                        // Increment probabilities for each non-hit position under ship
-                        x = ship.x;
-                        y = ship.y;
-                        for (uint8_t i = 0; i < ship.length; i++) {
-                            int16_t data = get_grid_data(target_grid, x, y);
-                            uint16_t pos = map_grid_pos(prob_grid, x, y);
-                            if (!(data & SHOT_POS)) {
-                                prob_grid->data[pos] += weight;
-                                grid_weight += weight;
-                            }
-                            move_x_y(&x, &y, ship.dir);
+                }
+                // Increment probabilities for each non-hit position under ship
+                for (uint8_t i = 0; i < rows; i++) {
+                    bb_row_t row = unshot.rows[top_y + i] & mask;
+                    for (int8_t x = top_x; row; x++) {
+                        if (row & ((bb_row_t) 1 << x)) {
+                            get_prob(prob_grid, x, top_y + i) += weight;
+                            grid_weight += weight;
+                            row &= ~((bb_row_t) 1 << x);
                         }
                     }
                 }
@@ -8,6 +8,19 @@
 #include "ship.h"
 #include "player.h"
 
+/* Access the weight of a position in a probability grid, stored row by row */
+#define get_prob(prob_grid, x, y) ((prob_grid)->weights[(y) * (prob_grid)->width + (x)])
+
+/**
+ * Structure holding a weight for each position of a grid. This is kept apart from grid_t
+ * as weights do not fit every grid storage format.
+ */
+typedef struct {
+    uint8_t width;
+    uint8_t height;
+    int16_t* weights;
+} prob_grid_t;
+
 /**
  * Attempt a shot on a target player using the statistically most likely 'hit' position. Position
  * is determined as the maximum location in a probability grid. If multiple equally weighted positions
@@ -18,6 +31,13 @@
  */
 bool make_weighted_shot(player_t* target);
 
+/**
+ * Allocate the required memory for a probability grid.
+ *
+ * @param prob_grid Probability grid with width/height set
+ */
+void allocate_prob_grid(prob_grid_t* prob_grid);
+
 /**
  * Find the max probability, and the number of occurrences, in a pre-generated probability grid. 
  * 
@@ -25,12 +45,13 @@ bool make_weighted_shot(player_t* target);
  * @param  max_val   Return pointer for max value
  * @return           The number of times max_val was found
  */
-uint16_t get_max_probability(grid_t* prob_grid, int16_t* max_val);
+uint16_t get_max_probability(prob_grid_t* prob_grid, int16_t* max_val);
 
 /**
  * Assign values to each position on a grid where the values are a estimation of how likely a ship
  * goes through it. If a predicted ship placement passes through it and a previous (undestroyed) hit,
  * the position is weighted higher than if it were just passing through un-shot squares.
+ * Under RuleNoTouch no predicted placement may pass next to a destroyed ship.
  * 
  * @param  target_grid Grid that is being targeted with previous hits/misses identified
  * @param  prob_grid   Grid with memory allocated (equal to target_grid) for return probabilities
@@ -38,7 +59,7 @@ uint16_t get_max_probability(grid_t* prob_grid, int16_t* max_val);
  * @param  ship_count  Number of ships passed
  * @return             The total weighting of the grid
  */
-uint16_t gen_probability_grid(grid_t* target_grid, grid_t* prob_grid, ship_t ships[], uint8_t ship_count);
+uint16_t gen_probability_grid(grid_t* target_grid, prob_grid_t* prob_grid, ship_t ships[], uint8_t ship_count);
 
 
 #endif // AI_H
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "ai_link.h"
+#include "link_proto.h"
+
+#include "lafortuna/uart/uart.h"
+
+/* Bytes accepted whilst waiting for a reply, stops line noise holding the game */
+#define AI_LINK_MAX_REPLY_BYTES (4 * LINK_FRAME_SIZE(2))
+
+void init_ai_link(void) {
+    os_init_uart();
+}
+
+
+bool make_remote_shot(player_t* target) {
+    // Send the target board state
+    uint8_t frame[LINK_FRAME_SIZE(LINK_MAX_PAYLOAD)];
+    uint16_t length = link_encode_request(frame, target->grid, target->ships, target->ship_count);
+    if (length > 0) {
+        uart_write(frame, length);
+
+        // Wait for a shot reply, one deadline covers however many bytes arrive
+        link_parser_t parser;
+        link_parser_reset(&parser);
+        uart_deadline_t deadline;
+        uart_start_deadline(&deadline, AI_LINK_TIMEOUT_MS);
+        uint8_t byte;
+        for (uint8_t i = 0; i < AI_LINK_MAX_REPLY_BYTES; i++) {
+            if (!uart_getc_deadline(&byte, &deadline)) {
+                break;
+            }
+            if (link_parse_byte(&parser, byte) && parser.type == LinkShotReply && parser.length == 2) {
+                int8_t x = parser.payload[0];
+                int8_t y = parser.payload[1];
+                if (shoot_pos(target, x, y) != Invalid) {
+                    target->last_x = x;
+                    target->last_y = y;
+                    return true;
+                }
+                break;
+            }
+        }
+    }
+    // Host unavailable so fall back to on-board AI
+    return make_weighted_shot(target);
+}
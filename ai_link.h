@@ -0,0 +1,35 @@
+#ifndef AI_LINK_H
+#define AI_LINK_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "player.h"
+#include "ai.h"
+
+/* Time to wait for a complete host reply before falling back to the on-board AI */
+#define AI_LINK_TIMEOUT_MS (1000)
+
+/* Wrapper macro selecting the CPU shot strategy (build with -DAI_LINK to offload) */
+#ifdef AI_LINK
+#define make_cpu_shot(target) (make_remote_shot(target))
+#else
+#define make_cpu_shot(target) (make_weighted_shot(target))
+#endif
+
+/**
+ * Initialise the serial link used to reach the host engine.
+ */
+void init_ai_link(void);
+
+/**
+ * Attempt a shot on a target player using a host engine. The known state of the target board
+ * is sent over the serial link and a reply with the position to shoot is awaited. If no valid
+ * reply arrives in time, or the reply targets an invalid position, make_weighted_shot is used.
+ *
+ * @param  target Player to target with shot
+ * @return        Whether a shot could be made
+ */
+bool make_remote_shot(player_t* target);
+
+#endif // AI_LINK_H
@@ -0,0 +1,23 @@
+#include "arena.h"
+
+void arena_init(arena_t* arena, uint8_t* buf, uint16_t size) {
+    arena->buf = buf;
+    arena->size = size;
+    arena->used = 0;
+}
+
+
+void* arena_alloc(arena_t* arena, uint16_t size) {
+    uint16_t aligned = ARENA_ALIGN(size);
+    if (aligned < size || aligned > arena->size - arena->used) {
+        return NULL;
+    }
+    void* ptr = &arena->buf[arena->used];
+    arena->used += aligned;
+    return ptr;
+}
+
+
+void arena_reset(arena_t* arena) {
+    arena->used = 0;
+}
@@ -0,0 +1,47 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Allocations are rounded up to keep pointers in the arena aligned */
+#define ARENA_ALIGNMENT   (sizeof(void*))
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT)
+
+/**
+ * Structure holding a bump allocator over a fixed buffer. Allocations are only released
+ * all at once by resetting the arena, so it cannot fragment.
+ */
+typedef struct {
+    uint8_t* buf;
+    uint16_t size;
+    uint16_t used;
+} arena_t;
+
+/**
+ * Set up an arena over a buffer, the buffer should be aligned to ARENA_ALIGNMENT.
+ *
+ * @param arena Arena to set up
+ * @param buf   Buffer to allocate from
+ * @param size  Size of the buffer
+ */
+void arena_init(arena_t* arena, uint8_t* buf, uint16_t size);
+
+/**
+ * Allocate memory from an arena. The memory is not cleared.
+ *
+ * @param  arena Arena to allocate from
+ * @param  size  Number of bytes required
+ * @return       Pointer to the memory, NULL if the arena does not have enough left
+ */
+void* arena_alloc(arena_t* arena, uint16_t size);
+
+/**
+ * Release every allocation made from an arena.
+ *
+ * @param arena Arena to reset
+ */
+void arena_reset(arena_t* arena);
+
+#endif // ARENA_H
@@ -0,0 +1,89 @@
+#include <string.h>
+
+#include "bitboard.h"
+
+void bb_clear(bitboard_t* bb) {
+    memset((void*) bb, 0, sizeof(bitboard_t));
+}
+
+
+bb_row_t bb_row_mask(uint8_t width) {
+    // Avoid shifting by the full row width as it is undefined
+    return width >= BB_ROW_BITS ? (bb_row_t) ~0 : (bb_row_t) (((bb_row_t) 1 << width) - 1);
+}
+
+
+void bb_dilate(bitboard_t* in, uint8_t width, uint8_t height, bitboard_t* out) {
+    bb_row_t mask = bb_row_mask(width);
+    bb_row_t prev = 0;
+    bb_row_t cur = height > 0 ? in->rows[0] : 0;
+    cur |= (cur << 1) | (cur >> 1);
+    for (uint8_t y = 0; y < height; y++) {
+        // Read the next row before this one is written in case in == out
+        bb_row_t next = y + 1 < height ? in->rows[y + 1] : 0;
+        next |= (next << 1) | (next >> 1);
+        out->rows[y] = (prev | cur | next) & mask;
+        prev = cur;
+        cur = next;
+    }
+}
+
+
+void bb_and_not(bitboard_t* a, bitboard_t* b, uint8_t height, bitboard_t* out) {
+    for (uint8_t y = 0; y < height; y++) {
+        out->rows[y] = a->rows[y] & ~b->rows[y];
+    }
+}
+
+
+uint16_t bb_popcount(bitboard_t* bb, uint8_t height) {
+    uint16_t count = 0;
+    for (uint8_t y = 0; y < height; y++) {
+        count += bb_row_popcount(bb->rows[y]);
+    }
+    return count;
+}
+
+
+bool bb_next(bitboard_t* bb, uint8_t height, uint8_t* x, uint8_t* y) {
+    for (; *y < height; (*y)++) {
+        bb_row_t row = bb->rows[*y];
+        if (row) {
+            *x = bb_row_select(row, 1);
+            bb->rows[*y] = row & (row - 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+
+uint8_t bb_row_popcount(bb_row_t row) {
+    uint8_t count = 0;
+    // Only iterates once per set bit
+    while (row) {
+        row &= row - 1;
+        count++;
+    }
+    return count;
+}
+
+
+uint8_t bb_row_select(bb_row_t row, uint8_t n) {
+    if (n == 0) {
+        return BB_ROW_BITS;
+    }
+    // Drop the lowest n - 1 set bits, the lowest remaining bit is the one selected
+    while (--n && row) {
+        row &= row - 1;
+    }
+    if (row == 0) {
+        return BB_ROW_BITS;
+    }
+    uint8_t col = 0;
+    while (!(row & 1)) {
+        row >>= 1;
+        col++;
+    }
+    return col;
+}
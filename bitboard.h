@@ -0,0 +1,121 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "board_size.h"
+
+/* Largest grid that can be represented, a row must fit in bb_row_t */
+#if GRID_MAX_SIZE > 16
+#define BB_ROW_BITS   (32)
+#else
+#define BB_ROW_BITS   (16)
+#endif
+#define BB_MAX_WIDTH  (GRID_MAX_SIZE)
+/* Only the rows of a fixed size grid are needed, every grid has them when sizes vary */
+#ifndef GRID_RUNTIME_SIZE
+#define BB_MAX_HEIGHT (GRID_FIXED_HEIGHT)
+#else
+#define BB_MAX_HEIGHT (GRID_MAX_SIZE)
+#endif
+
+/* Wrapper macros for single bit access, no bounds checks are applied */
+#define bb_test(bb, x, y)  (((bb)->rows[y] >> (x)) & 1)
+#define bb_set(bb, x, y)   ((bb)->rows[y] |= (bb_row_t) 1 << (x))
+#define bb_reset(bb, x, y) ((bb)->rows[y] &= ~((bb_row_t) 1 << (x)))
+
+/**
+ * Type of a single bitboard row, bit n represents column n. Rows only widen when
+ * boards larger than 16 positions are enabled.
+ */
+#if BB_ROW_BITS > 16
+typedef uint32_t bb_row_t;
+#else
+typedef uint16_t bb_row_t;
+#endif
+
+/**
+ * Structure holding one bit per grid position, stored row by row.
+ * Bits outside the grid dimensions it is used with are kept clear.
+ */
+typedef struct {
+    bb_row_t rows[BB_MAX_HEIGHT];
+} bitboard_t;
+
+/**
+ * Clear all bits of a bitboard.
+ *
+ * @param bb Bitboard to clear
+ */
+void bb_clear(bitboard_t* bb);
+
+/**
+ * Get a row mask with the bits for all columns of a grid of the given width set.
+ *
+ * @param  width Grid width
+ * @return       Row mask
+ */
+bb_row_t bb_row_mask(uint8_t width);
+
+/**
+ * Dilate a bitboard so that every position next to (including diagonally) or on a set
+ * position is set. The input and output may be the same bitboard.
+ *
+ * @param in     Bitboard to dilate
+ * @param width  Width of the grid
+ * @param height Height of the grid
+ * @param out    Dilated bitboard
+ */
+void bb_dilate(bitboard_t* in, uint8_t width, uint8_t height, bitboard_t* out);
+
+/**
+ * Set out to the bits set in a but not in b, out may be the same as either input.
+ *
+ * @param a      Bitboard of bits to keep
+ * @param b      Bitboard of bits to remove
+ * @param height Height of the grid
+ * @param out    Result bitboard
+ */
+void bb_and_not(bitboard_t* a, bitboard_t* b, uint8_t height, bitboard_t* out);
+
+/**
+ * Count the set bits in a bitboard.
+ *
+ * @param  bb     Bitboard to count
+ * @param  height Height of the grid
+ * @return        Number of set bits
+ */
+uint16_t bb_popcount(bitboard_t* bb, uint8_t height);
+
+/**
+ * Find and clear the first set bit in row order, starting from a given row. Repeated calls
+ * on a copy of a bitboard iterate over its set positions.
+ *
+ * @param  bb     Bitboard to search, the bit found is cleared
+ * @param  height Height of the grid
+ * @param  x      Return pointer for the column found
+ * @param  y      Row to start from, updated with the row found
+ * @return        Whether a set bit was found
+ */
+bool bb_next(bitboard_t* bb, uint8_t height, uint8_t* x, uint8_t* y);
+
+/**
+ * Count the set bits in a row.
+ *
+ * @param  row Row to count
+ * @return     Number of set bits
+ */
+uint8_t bb_row_popcount(bb_row_t row);
+
+/**
+ * Find the column of the n'th set bit in a row.
+ *
+ * @param  row Row to search
+ * @param  n   Set bit to find, counting from 1 at column 0
+ * @return     Column of the bit, BB_ROW_BITS if the row has fewer than n bits set
+ */
+uint8_t bb_row_select(bb_row_t row, uint8_t n);
+
+#endif // BITBOARD_H
@@ -0,0 +1,33 @@
+#ifndef BOARD_SIZE_H
+#define BOARD_SIZE_H
+
+/* Grid dimensions are fixed at compile time, with the data plane held in the grid, unless
+ * built with -DGRID_RUNTIME_SIZE. The fixed size can be set with -DGRID_FIXED_WIDTH/HEIGHT. */
+#ifndef GRID_RUNTIME_SIZE
+#ifndef GRID_FIXED_WIDTH
+#define GRID_FIXED_WIDTH  (10)
+#endif
+#ifndef GRID_FIXED_HEIGHT
+#define GRID_FIXED_HEIGHT (10)
+#endif
+#endif
+
+/* Largest width/height any grid may have, set with -DGRID_MAX_SIZE=n. Defaults to 16 so
+ * bitboard rows fit 16 bits, or 26 when a larger fixed size is chosen. */
+#ifndef GRID_MAX_SIZE
+#if !defined(GRID_RUNTIME_SIZE) && (GRID_FIXED_WIDTH > 16 || GRID_FIXED_HEIGHT > 16)
+#define GRID_MAX_SIZE (26)
+#else
+#define GRID_MAX_SIZE (16)
+#endif
+#endif
+
+/* Positions are labelled A-Z along the bottom axis */
+#if GRID_MAX_SIZE > 26
+#error "GRID_MAX_SIZE must not exceed 26"
+#endif
+#if !defined(GRID_RUNTIME_SIZE) && (GRID_FIXED_WIDTH > GRID_MAX_SIZE || GRID_FIXED_HEIGHT > GRID_MAX_SIZE)
+#error "GRID_FIXED_WIDTH/HEIGHT must not exceed GRID_MAX_SIZE"
+#endif
+
+#endif // BOARD_SIZE_H
@@ -1,14 +1,21 @@
 #include <stdio.h>
+#include <string.h>
 #include <stdbool.h>
 
 #include "control.h"
 #include "game.h"
 #include "ui_drawing.h"
 #include "ai.h"
+#include "ai_link.h"
+#include "mem_report.h"
 
 #include "lafortuna/os.h"
 
-void update_ship_position(player_t* player, ship_t* cur_ship, ship_t* next_ship, draw_props_t* draw_props);
+const char str_press_continue[] PROGMEM = "Press 'Centre' to continue...";
+
+void update_ship_position(player_t* player, ship_t* cur_ship, ship_t* next_ship, place_valid_t validation,
+    draw_props_t* draw_props);
+void update_placement_preview(player_t* player, ship_t* ship, bitboard_t* shown, draw_props_t* draw_props);
 
 void play_battleships(bool player_one_cpu, bool player_two_cpu) {
     // Initialise a new game
@@ -18,14 +25,20 @@ void play_battleships(bool player_one_cpu, bool player_two_cpu) {
     game.player_two->cpu = player_two_cpu;
 
     // Placement phase
+    begin_mem_phase();
     placement_phase(&game, PLAYER_ONE);
     placement_phase(&game, PLAYER_TWO);
+    end_mem_phase(MemPlacement);
 
     // Shooting face
+    begin_mem_phase();
     shooting_phase(&game);
+    end_mem_phase(MemShooting);
 
     // Game over
+    begin_mem_phase();
     finish_phase(&game);
+    end_mem_phase(MemFinish);
     free_game(&game);
 }
 
@@ -52,23 +65,24 @@ void placement_phase(game_t* game, uint8_t player_idx) {
 
     // Two player game so must display separation screen
     if (!game->player_one->cpu && !game->player_two->cpu) {
-        show_next_player_screen("Place your ships", player_idx);
+        show_next_player_screen(PSTR("Place your ships"), player_idx);
     }
 
     // Wait for ship placement
     draw_props_t draw_props;
     generate_one_grid_view(&draw_props);
     draw_props.ships = true; 
+    draw_props.preview = PLACEMENT_PREVIEW;
     clear_screen();
     draw_header();
     write_current_player(player_idx);
     draw_footer();
     uint8_t temp = display.background;
     display.background = MESSAGE_BOX_BG;
-    draw_centred_string("Arrows: Movement - Centre: Rotate\n", &footer);
-    draw_centred_string("\nLong Press Centre: Place", &footer);
+    draw_centred_string_P(PSTR("Arrows: Movement - Centre: Rotate\n"), &footer);
+    draw_centred_string_P(PSTR("\nLong Press Centre: Place"), &footer);
     display.background = temp;
-    draw_title("SHIP PLACER", &draw_props);
+    draw_title(PSTR("SHIP PLACER"), &draw_props);
     draw_grid(player->grid, &draw_props);
     player_ships_placer(player, &draw_props);
 }
@@ -78,9 +92,11 @@ void shooting_phase(game_t* game) {
     // Split view so LHS is shooting area, RHS is shots against player
     draw_props_t grid_1_draw_props;
     draw_props_t grid_2_draw_props;   
-    generate_two_grid_view(&grid_1_draw_props, &grid_2_draw_props, 0.57);
+    generate_two_grid_view(&grid_1_draw_props, &grid_2_draw_props, 57, 100);
     grid_1_draw_props.ships = false;
     grid_2_draw_props.ships = true; 
+    grid_1_draw_props.preview = false;
+    grid_2_draw_props.preview = false;
 
     clear_screen();
     while (!is_player_destroyed(game->player_one) && !is_player_destroyed(game->player_two)) {
@@ -89,7 +105,7 @@ void shooting_phase(game_t* game) {
 
         // Two player game so must display separation screen 
         if (!game->player_one->cpu && !game->player_two->cpu) {
-            show_next_player_screen("Take your shot", game->turn);
+            show_next_player_screen(PSTR("Take your shot"), game->turn);
         }
 
         // Require redraw if both CPU's, if both are not CPUs, or first shot
@@ -104,7 +120,7 @@ void shooting_phase(game_t* game) {
         bool draw_updates = !cur_player->cpu || enemy_player->cpu;
         if (draw_updates) {
             write_current_turn(game->shots / 2 + 1);
-            draw_shot_overlay(cur_player->grid, &grid_2_draw_props);
+            draw_shot_changes(cur_player->grid, &grid_2_draw_props);
             char buf[50];
             bool message = get_last_action_message(buf, game);
             show_footer_message(message ? buf : NULL, false);
@@ -112,7 +128,7 @@ void shooting_phase(game_t* game) {
 
         // Make shot
         if (cur_player->cpu) {
-            make_weighted_shot(enemy_player);
+            make_cpu_shot(enemy_player);
         } else {   
             shot_position_selector(enemy_player, &grid_1_draw_props);
             shoot_pos(enemy_player, enemy_player->last_x, enemy_player->last_y);
@@ -121,7 +137,7 @@ void shooting_phase(game_t* game) {
 
         // Wait if not a CPU turn (unless both are CPUs)
         if (!cur_player->cpu  || enemy_player->cpu) {
-            draw_shot_overlay(enemy_player->grid, &grid_1_draw_props);
+            draw_shot_changes(enemy_player->grid, &grid_1_draw_props);
             char buf[50];
             bool message = get_last_action_message(buf, game);
             show_footer_message(message ? buf : NULL, !cur_player->cpu);
@@ -138,9 +154,11 @@ void finish_phase(game_t* game) {
     clear_screen();
     draw_props_t grid_1_draw_props;
     draw_props_t grid_2_draw_props;   
-    generate_two_grid_view(&grid_1_draw_props, &grid_2_draw_props, 0.5);
+    generate_two_grid_view(&grid_1_draw_props, &grid_2_draw_props, 1, 2);
     grid_1_draw_props.ships = true;
     grid_2_draw_props.ships = true;
+    grid_1_draw_props.preview = false;
+    grid_2_draw_props.preview = false;
     draw_finish_state(game, &grid_1_draw_props, &grid_2_draw_props);
     show_footer_message(NULL, true);
 }
@@ -156,18 +174,21 @@ bool get_last_action_message(char* buf, game_t* game) {
         last_shooter->last_x, last_shooter->last_y);
     bool hit = IS_HIT(data);
     bool destroy = data & DESTROY_POS;
-    const char* ship = last_shooter->ships[(data & POS_DATA) - 1].name;
+    char ship[SHIP_NAME_SIZE];
+    if (hit) {
+        strcpy_P(ship, get_ship_name(&last_shooter->fleet[get_ship_idx(data & POS_DATA)]));
+    }
     if (game->turn == last_shooter_idx) {
         if (!hit) {
-            sprintf(buf, "The enemy missed!");
+            strcpy_P(buf, PSTR("The enemy missed!"));
         } else {
-            sprintf(buf, "The enemy %s your '%s'", destroy ? "destroyed" : "hit", ship);
+            sprintf_P(buf, destroy ? PSTR("The enemy destroyed your '%s'") : PSTR("The enemy hit your '%s'"), ship);
         }
     } else {
         if (destroy) {
-            sprintf(buf, "You destroyed the enemy '%s'", ship);
+            sprintf_P(buf, PSTR("You destroyed the enemy '%s'"), ship);
         } else {
-            sprintf(buf, hit ? "Hit!" : "Miss!");
+            strcpy_P(buf, hit ? PSTR("Hit!") : PSTR("Miss!"));
         }
     }
     return true;
@@ -180,12 +201,16 @@ void show_footer_message(char* message, bool wait) {
     draw_footer();
     char buf[50];
     if (message) {
-        sprintf(buf, "%s%s", message, wait ? "\n" : "");
+        strcpy(buf, message);
+        if (wait) {
+            strcat_P(buf, PSTR("\n"));
+        }
         draw_centred_string(buf, &footer);
     }
 
     if (wait) {
-        sprintf(buf, "%sPress 'Centre' to continue...",  message ? "\n" : "");
+        strcpy_P(buf, message ? PSTR("\n") : PSTR(""));
+        strcat_P(buf, str_press_continue);
         draw_centred_string(buf, &footer);
         wait_for_press(SWC);
     }
@@ -193,22 +218,25 @@ void show_footer_message(char* message, bool wait) {
 }
 
 
-void show_next_player_screen(char* message, uint8_t player_idx) {
+void show_next_player_screen(PGM_P message, uint8_t player_idx) {
     clear_screen();
 
     char buf[50];
-    char* player_str = "";
+    PGM_P player_str = PSTR("");
     switch (player_idx) {
     case PLAYER_ONE:
-        player_str = PLAYER_ONE_STR_UP;
+        player_str = PSTR("PLAYER " PLAYER_ONE_STR_UP ": ");
         break;
     case PLAYER_TWO:
-        player_str = PLAYER_TWO_STR_UP;
+        player_str = PSTR("PLAYER " PLAYER_TWO_STR_UP ": ");
         break;
     }
-    sprintf(buf, "PLAYER %s: %s\n", player_str, message);
+    strcpy_P(buf, player_str);
+    strcat_P(buf, message);
+    strcat_P(buf, PSTR("\n"));
     draw_centred_string(buf, &draw_area);
-    sprintf(buf, "\nPress 'Centre' to continue...");
+    strcpy_P(buf, PSTR("\n"));
+    strcat_P(buf, str_press_continue);
     draw_centred_string(buf, &draw_area);
     wait_for_press(SWC);
     clear_screen();
@@ -233,12 +261,10 @@ void shot_position_selector(player_t* target, draw_props_t* draw_props) {
             // Check whether update is valid
             g_data next_data = get_grid_data(target->grid, next_x, next_y);
             if (next_data != BLOCKED_POS) {
-                // Move the selection
-                clear_selection(target, target->last_x, target->last_y, draw_props);
-
+                // Move the selection, repainting only the squares it touched
                 valid = !(next_data & SHOT_POS);
-                draw_selection(target->grid, next_x, next_y, draw_props,
-                               valid ?  VALID_SEL : INVALID_SEL);
+                select_grid_pos(draw_props, next_x, next_y, valid ?  VALID_SEL : INVALID_SEL);
+                flush_grid_damage(target, draw_props);
 
                 // Update the selection coordinates
                 target->last_x = next_x;
@@ -265,22 +291,34 @@ void shot_position_selector(player_t* target, draw_props_t* draw_props) {
             update = true;
         }
     }
-    clear_selection(target, target->last_x, target->last_y, draw_props);
+    clear_selection(target, draw_props);
 }
 
 
 void player_ships_placer(player_t* player, draw_props_t* draw_props) {
+    bitboard_t preview;
+    bb_clear(&preview);
     for (uint8_t ship_idx = 0; ship_idx < player->ship_count; ship_idx++) {
         ship_t* cur_ship = &player->ships[ship_idx];
-        update_ship_position(player, NULL, cur_ship, draw_props);
+        update_placement_preview(player, cur_ship, &preview, draw_props);
+        update_ship_position(player, NULL, cur_ship, validate_ship_position(player->grid, cur_ship), draw_props);
 
         // Wait for user to place this ship
         player_ship_placer(player, cur_ship, draw_props);
     }
+    update_placement_preview(player, NULL, &preview, draw_props);
 }
 
 
 void player_ship_placer(player_t* player, ship_t* cur_ship, draw_props_t* draw_props) {
+    // Generate the ship's placements once so input is handled with mask tests only
+    grid_t* grid = player->grid;
+    uint8_t ref = get_ship_ref(cur_ship - player->ships);
+    avail_masks_t avail;
+    gen_availability_masks(get_blocked_bitboard(grid), grid->width, grid->height, cur_ship->length, &avail);
+    uint8_t valid_dirs = get_valid_rotations(&avail, cur_ship->x, cur_ship->y);
+    uint8_t grid_dirs = get_on_grid_rotations(grid, cur_ship->x, cur_ship->y, cur_ship->length);
+
     while (!cur_ship->placed) {
         // Modify a copy so validation can take place
         ship_t next_ship = *cur_ship;
@@ -298,21 +336,42 @@ void player_ship_placer(player_t* player, ship_t* cur_ship, draw_props_t* draw_p
             // Capture ship rotate event
         } else if (get_switch_short(_BV(SWC))) {
             do {
-                // Find the first valid CW rotation
+                // Find the first CW rotation that stays on the grid
                 next_ship.dir = (next_ship.dir + 1) % (D_West + 1);
-                if (validate_ship_position(player->grid, &next_ship) != OffGrid) {
-                    break;
-                }
-            } while (next_ship.dir != cur_ship->dir);
+            } while (!(grid_dirs & _BV(next_ship.dir)) && next_ship.dir != cur_ship->dir);
             // Capture ship place event (Long centre press)
         } else if (get_switch_long(_BV(SWC))) {
-            place_ship(player->grid, &next_ship, true);
+            if (valid_dirs & _BV(next_ship.dir)) {
+                place_ship(grid, &next_ship, ref, false);
+            }
         }
 
         // Process result of captured input
         if (move_dir != NO_DIR || next_ship.dir != cur_ship->dir || next_ship.placed) {
-            move_x_y(&next_ship.x, &next_ship.y, move_dir);
-            update_ship_position(player, cur_ship, &next_ship, draw_props);
+            uint8_t next_valid_dirs = valid_dirs;
+            uint8_t next_grid_dirs = grid_dirs;
+            if (move_dir != NO_DIR) {
+                int8_t next_x = next_ship.x;
+                int8_t next_y = next_ship.y;
+                move_x_y(&next_x, &next_y, move_dir);
+                next_valid_dirs = get_valid_rotations(&avail, next_x, next_y);
+                next_grid_dirs = get_on_grid_rotations(grid, next_x, next_y, next_ship.length);
+                // An off grid position does not fit the ship's fields but is then ignored
+                next_ship.x = next_x;
+                next_ship.y = next_y;
+            }
+            place_valid_t validation = OffGrid;
+            if (next_valid_dirs & _BV(next_ship.dir)) {
+                validation = PlaceValid;
+            } else if (next_grid_dirs & _BV(next_ship.dir)) {
+                validation = Overlap; // Also covers touching, both are drawn as invalid
+            }
+            update_ship_position(player, cur_ship, &next_ship, validation, draw_props);
+            // Off grid moves are ignored so only take the new origin's rotations if it moved
+            if (validation != OffGrid) {
+                valid_dirs = next_valid_dirs;
+                grid_dirs = next_grid_dirs;
+            }
         }
     }
     clear_ship_selection(player, cur_ship, draw_props);
@@ -350,10 +409,11 @@ dir_t get_move_dir(void) {
  * @param player     Player doing update
  * @param cur_ship   Current ship selection
  * @param next_ship  Next ship selection
+ * @param validation Validation of the next ship selection
  * @param draw_props Drawing constraints
  */
-void update_ship_position(player_t* player, ship_t* cur_ship, ship_t* next_ship, draw_props_t* draw_props) {
-    place_valid_t validation = validate_ship_position(player->grid, next_ship);
+void update_ship_position(player_t* player, ship_t* cur_ship, ship_t* next_ship, place_valid_t validation,
+    draw_props_t* draw_props) {
     uint16_t colour;
 
     switch (validation) {
@@ -379,3 +439,31 @@ void update_ship_position(player_t* player, ship_t* cur_ship, ship_t* next_ship,
         *cur_ship = *next_ship;
     }
 }
+
+/**
+ * Shade every position a ship can be placed from, if enabled by the drawing properties. The preview is
+ * generated from the ship's availability masks and only positions that have changed are redrawn.
+ *
+ * @param player     Player placing ships
+ * @param ship       Ship being placed, NULL to clear the preview
+ * @param shown      Currently shown preview, updated to match
+ * @param draw_props Drawing constraints
+ */
+void update_placement_preview(player_t* player, ship_t* ship, bitboard_t* shown, draw_props_t* draw_props) {
+    if (!draw_props->preview) {
+        return;
+    }
+    bitboard_t shade;
+    bb_clear(&shade);
+    if (ship != NULL) {
+        grid_t* grid = player->grid;
+        avail_masks_t avail;
+        gen_availability_masks(get_blocked_bitboard(grid), grid->width, grid->height, ship->length, &avail);
+        for (uint8_t y = 0; y < grid->height; y++) {
+            for (dir_t dir = D_North; dir <= D_West; dir++) {
+                shade.rows[y] |= avail.dir[dir].rows[y];
+            }
+        }
+    }
+    update_preview_overlay(player, shown, &shade, draw_props);
+}
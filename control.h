@@ -9,6 +9,14 @@
 #include "game.h"
 #include "grid_drawing.h"
 
+/* Whether to shade every position the current ship can be placed from whilst placing */
+#ifndef PLACEMENT_PREVIEW
+#define PLACEMENT_PREVIEW (true)
+#endif
+
+/* Prompt shown whilst waiting for a centre button press, in program memory */
+extern const char str_press_continue[];
+
 /**
  * Initialise a game of battleships. This will use a default setup. This is the main control flow of
  * a battleships game so will not return until the game is complete.
@@ -67,10 +75,10 @@ void show_footer_message(char* message, bool wait);
  * Draw a separation screen that indicates who the next player is. Display the given message.
  * Progress can be made with a centre button press at which point the display is cleared.
  * 
- * @param message    Message to display
+ * @param message    Message to display, in program memory
  * @param player_idx The next player
  */
-void show_next_player_screen(char* message, uint8_t player_idx);
+void show_next_player_screen(PGM_P message, uint8_t player_idx);
 
 /** 
  * Get a user input referencing which position to target with the shot. The selected position is set
@@ -0,0 +1,28 @@
+#ifndef FLASH_H
+#define FLASH_H
+
+/*
+ * Constant strings and tables kept in program memory. On AVR these must be read with the
+ * pgm_read_* and *_P functions as flash has its own address space. Host builds of the shared
+ * game modules have a single address space so the same names map onto plain C.
+ */
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#else
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P               const char*
+#define PSTR(s)             (s)
+#define pgm_read_byte(addr) (*(const uint8_t*) (addr))
+#define pgm_read_ptr(addr)  (*(const void* const*) (addr))
+#define strlen_P            strlen
+#define strcpy_P            strcpy
+#define strcat_P            strcat
+#define sprintf_P           sprintf
+#define printf_P            printf
+#endif
+
+#endif // FLASH_H
@@ -4,49 +4,54 @@
 #include "player.h"
 #include "ship.h"
 
+#ifndef GRID_RUNTIME_SIZE
+#define DEFAULT_GRID_WIDTH   (GRID_FIXED_WIDTH)
+#define DEFAULT_GRID_HEIGHT  (GRID_FIXED_HEIGHT)
+#else
 #define DEFAULT_GRID_WIDTH   (10)
 #define DEFAULT_GRID_HEIGHT  (10)
-#define DEFAULT_SHIP_COUNT   (5)
+#endif
+#define DEFAULT_SHIP_COUNT   (GAME_MAX_SHIPS)
 
-/** Global declarations of ship names */
-const char* str_destroyer  = "Destroyer";
-const char* str_submarine  = "Submarine";
-const char* str_cruiser    = "Cruiser";
-const char* str_battleship = "Battleship";
-const char* str_carrier    = "Carrier";
+/** Memory for every allocation of the current game, sized at compile time */
+static uint8_t game_arena_buf[GAME_ARENA_SIZE] __attribute__((aligned(ARENA_ALIGNMENT)));
+static arena_t game_arena = {.buf = game_arena_buf, .size = sizeof(game_arena_buf), .used = 0};
+
+
+/** Default fleet, shared by both players */
+static const ship_def_t default_fleet[DEFAULT_SHIP_COUNT] PROGMEM = {
+    {.name = ShipDestroyer,  .length = 2},
+    {.name = ShipSubmarine,  .length = 3},
+    {.name = ShipCruiser,    .length = 3},
+    {.name = ShipBattleship, .length = 4},
+    {.name = ShipCarrier,    .length = 5},
+};
 
 
 void make_default_game(game_t* game) {
     // Initialise game properties
     uint8_t width  = DEFAULT_GRID_WIDTH;
-    uint8_t height = DEFAULT_GRID_WIDTH;
+    uint8_t height = DEFAULT_GRID_HEIGHT;
 
-    uint8_t ship_count = 5;
-    ship_t ships[DEFAULT_SHIP_COUNT] = {
-        {.name = str_destroyer,  .ref = 1, .length = 2, SHIP_DEFAULTS},
-        {.name = str_submarine,  .ref = 2, .length = 3, SHIP_DEFAULTS},
-        {.name = str_cruiser,    .ref = 3, .length = 3, SHIP_DEFAULTS},
-        {.name = str_battleship, .ref = 4, .length = 4, SHIP_DEFAULTS},
-        {.name = str_carrier,    .ref = 5, .length = 5, SHIP_DEFAULTS},
-    };
+    uint8_t ship_count = DEFAULT_SHIP_COUNT;
 
     // Initialise game
     game->turn = PLAYER_ONE;
     game->shots = 0;
-    game->player_one = malloc(sizeof(player_t));
-    game->player_two = malloc(sizeof(player_t));
+    arena_reset(&game_arena);
+    game->player_one = arena_alloc(&game_arena, sizeof(player_t));
+    game->player_two = arena_alloc(&game_arena, sizeof(player_t));
 
-    make_player(game->player_one, width, height, ships, ship_count);    
-    make_player(game->player_two, width, height, ships, ship_count);
+    // The arena is sized for the default game so cannot run out
+    make_player(game->player_one, &game_arena, width, height, default_fleet, ship_count);
+    make_player(game->player_two, &game_arena, width, height, default_fleet, ship_count);
 }
 
 
 void free_game(game_t* game) {
-    free_player(game->player_one);
-    free(game->player_one);
-
-    free_player(game->player_two);
-    free(game->player_two);
+    arena_reset(&game_arena);
+    game->player_one = NULL;
+    game->player_two = NULL;
 }
 
 
@@ -10,25 +10,41 @@
 #define PLAYER_ONE (1)
 #define PLAYER_TWO (2)
 
+/* Largest fleet a player can have */
+#define GAME_MAX_SHIPS (5)
+
+/* Grid data taken from the arena, held in the grid when the size is fixed */
+#ifdef GRID_RUNTIME_SIZE
+#define GAME_GRID_DATA_SIZE (ARENA_ALIGN(GRID_DATA_SIZE(GRID_MAX_SIZE, GRID_MAX_SIZE)))
+#else
+#define GAME_GRID_DATA_SIZE (0)
+#endif
+
+/* Exact number of bytes every allocation of a game needs: two players, their grids and ships */
+#define GAME_ARENA_SIZE (2 * (ARENA_ALIGN(sizeof(player_t)) + ARENA_ALIGN(sizeof(grid_t)) + \
+    ARENA_ALIGN(GAME_MAX_SHIPS * sizeof(ship_t)) + GAME_GRID_DATA_SIZE))
+
 /**
  * Structure holding state information for a game.
  */
 typedef struct {
     uint8_t turn;
-    uint8_t shots;
+    uint16_t shots;
     player_t* player_one;
     player_t* player_two;
 } game_t;
 
 /**
- * Update the current game with a copy of the defaults.
+ * Update the current game with a copy of the defaults. All memory for the game is taken
+ * from the game arena, which is reset first so only one game can exist at a time.
  * 
  * @param game Pointer to game to update
  */
 void make_default_game(game_t* game);
 
 /**
- * Free all memory used by a game, this will stop the game being usable.
+ * Free all memory used by a game by resetting the game arena, this will stop the game
+ * being usable.
  *
  * @param game Game for which to free
  */
@@ -2,25 +2,33 @@
 #include <string.h>
 
 #include "grid.h"
+#include "flash.h"
+
+/* Function Prototypes */
+g_data get_flagged_data(grid_t* grid, uint8_t data, int8_t x, int8_t y);
+void record_grid_change(grid_t* grid, int8_t x, int8_t y);
+
 
 void print_grid(grid_t* grid) {
     for (int8_t y = 0; y < grid->height; y++) {
+        grid_iter_t iter = grid_row_iter(grid, y);
         for (int8_t x = 0; x < grid->width; x++) {
-            printf("%d ", get_grid_data(grid, x, y));
+            printf_P(PSTR("%d "), get_flagged_data(grid, grid_iter_next(&iter), x, y));
         }
-        printf("\n");
+        putchar('\n');
     }
 }
 
 
 void print_ship_grid(grid_t* grid) {
     for (int8_t y = 0; y < grid->height; y++) {
+        grid_iter_t iter = grid_row_iter(grid, y);
         for (int8_t x = 0; x < grid->width; x++) {
-            int16_t data = get_grid_data(grid, x, y);
-            printf("%0d%s%s ", data & POS_DATA, data & SHOT_POS ?
-                   (IS_HIT(data) ? "H" : "M") : " ", data & DESTROY_POS ? "D" : " ");
+            int16_t data = get_flagged_data(grid, grid_iter_next(&iter), x, y);
+            printf_P(PSTR("%0d%c%c "), data & POS_DATA, data & SHOT_POS ?
+                   (IS_HIT(data) ? 'H' : 'M') : ' ', data & DESTROY_POS ? 'D' : ' ');
         }
-        printf("\n");
+        putchar('\n');
     }
 }
 
@@ -38,53 +46,210 @@ bool is_pos_destroyed(grid_t* grid, int8_t x, int8_t y) {
 
 
 void mark_shot(grid_t* grid, int8_t x, int8_t y) {
-    uint16_t pos = map_grid_pos(grid, x, y);
-    grid->data[pos] |= SHOT_POS;
+    if (map_grid_pos(grid, x, y) != BLOCKED_POS) {
+        bb_set(&grid->shot, x, y);
+        record_grid_change(grid, x, y);
+    }
 }
 
 
 void mark_destroyed(grid_t* grid, int8_t x, int8_t y) {
-    uint16_t pos = map_grid_pos(grid, x, y);
-    grid->data[pos] |= DESTROY_POS;
+    if (map_grid_pos(grid, x, y) != BLOCKED_POS) {
+        bb_set(&grid->destroyed, x, y);
+        record_grid_change(grid, x, y);
+    }
 }
 
 
-void allocate_grid_data(grid_t* grid, bool clear) {
-    // Attempt memory allocation
-    uint16_t length = grid->width * grid->height * sizeof(g_data);
-    grid->data = malloc(length);
-    if (clear) {
-        zero_grid_data(grid);
+void get_hit_bitboard(grid_t* grid, bitboard_t* hits) {
+    for (uint8_t y = 0; y < grid->height; y++) {
+        hits->rows[y] = grid->shot.rows[y] & grid->occupied.rows[y];
     }
 }
 
 
-void zero_grid_data(grid_t* grid) {
-    uint16_t length = grid->width * grid->height * sizeof(g_data);
-    if (grid->data != NULL) {
-        memset((void*) grid->data, 0, length);
+void get_miss_bitboard(grid_t* grid, bitboard_t* misses) {
+    bb_and_not(&grid->shot, &grid->occupied, grid->height, misses);
+}
+
+
+void get_unshot_bitboard(grid_t* grid, bitboard_t* unshot) {
+    bb_row_t row_mask = bb_row_mask(grid->width);
+    for (uint8_t y = 0; y < grid->height; y++) {
+        unshot->rows[y] = ~grid->shot.rows[y] & row_mask;
+    }
+}
+
+
+uint16_t count_unshot_positions(grid_t* grid, bitboard_t* mask) {
+    uint16_t count = 0;
+    for (uint8_t y = 0; y < grid->height; y++) {
+        count += bb_row_popcount(mask->rows[y] & ~grid->shot.rows[y]);
     }
+    return count;
+}
+
+
+uint16_t get_grid_data_size(uint8_t width, uint8_t height) {
+    return GRID_DATA_SIZE(width, height);
 }
 
 
 g_data get_grid_data(grid_t* grid, int8_t x, int8_t y) {
-    int16_t pos = map_grid_pos(grid, x, y);
-    return pos == BLOCKED_POS ? BLOCKED_POS : grid->data[pos];
+    grid_index_t pos = map_grid_pos(grid, x, y);
+    if (pos == BLOCKED_POS) {
+        return BLOCKED_POS;
+    }
+    return get_flagged_data(grid, get_plane_data(grid, pos), x, y);
+}
+
+
+/**
+ * Combine a data plane value with the flags held for its position.
+ *
+ * @param  grid Grid the value was read from
+ * @param  data Data plane value
+ * @param  x    x coordinate, must be on the grid
+ * @param  y    y coordinate, must be on the grid
+ * @return      Grid data with flags
+ */
+g_data get_flagged_data(grid_t* grid, uint8_t data, int8_t x, int8_t y) {
+    g_data flagged = data;
+    if (bb_test(&grid->shot, x, y)) {
+        flagged |= SHOT_POS;
+    }
+    if (bb_test(&grid->destroyed, x, y)) {
+        flagged |= DESTROY_POS;
+    }
+    return flagged;
 }
 
 
 void set_grid_data(grid_t* grid, int8_t x, int8_t y, g_data data) {
-    int16_t pos = map_grid_pos(grid, x, y);
-    if (pos != BLOCKED_POS) {
-        grid->data[pos] = data;
+    grid_index_t pos = map_grid_pos(grid, x, y);
+    if (pos == BLOCKED_POS) {
+        return;
     }
+    set_plane_data(grid, pos, data & PLANE_MASK);
+    // Keep the flag planes in step with the data
+    bb_reset(&grid->shot, x, y);
+    bb_reset(&grid->destroyed, x, y);
+    bb_reset(&grid->occupied, x, y);
+    if (data & SHOT_POS) {
+        bb_set(&grid->shot, x, y);
+    }
+    if (data & DESTROY_POS) {
+        bb_set(&grid->destroyed, x, y);
+    }
+    if (data & PLANE_MASK) {
+        bb_set(&grid->occupied, x, y);
+    }
+    record_grid_change(grid, x, y);
 }
 
 
-int16_t map_grid_pos(grid_t* grid, int8_t x, int8_t y) {
-    if (x >= 0 && x < grid->width && y >= 0 && y < grid->height) {
-        return x * grid->height + y;
-    } else {
-        return BLOCKED_POS;
+void invalidate_grid_journal(grid_t* grid) {
+    // Put every synced cursor more than a journal behind
+    grid->journal.epoch += GRID_JOURNAL_SIZE + 1;
+}
+
+
+void sync_grid_cursor(grid_t* grid, grid_cursor_t* cursor) {
+    cursor->grid = grid;
+    cursor->epoch = grid->journal.epoch;
+}
+
+
+bool is_grid_cursor_valid(grid_t* grid, grid_cursor_t* cursor) {
+    return cursor->grid == grid && (uint16_t) (grid->journal.epoch - cursor->epoch) <= GRID_JOURNAL_SIZE;
+}
+
+
+bool next_grid_change(grid_t* grid, grid_cursor_t* cursor, int8_t* x, int8_t* y) {
+    if (cursor->epoch == grid->journal.epoch) {
+        return false;
+    }
+    uint8_t entry = cursor->epoch & (GRID_JOURNAL_SIZE - 1);
+    *x = grid->journal.x[entry];
+    *y = grid->journal.y[entry];
+    cursor->epoch++;
+    return true;
+}
+
+
+/**
+ * Record that a position of a grid has changed in its journal.
+ *
+ * @param grid Grid that changed
+ * @param x    x coordinate, must be on the grid
+ * @param y    y coordinate, must be on the grid
+ */
+void record_grid_change(grid_t* grid, int8_t x, int8_t y) {
+    uint8_t entry = grid->journal.epoch & (GRID_JOURNAL_SIZE - 1);
+    grid->journal.x[entry] = x;
+    grid->journal.y[entry] = y;
+    grid->journal.epoch++;
+}
+
+
+bool allocate_grid_data(grid_t* grid, bool clear) {
+#ifndef GRID_RUNTIME_SIZE
+    // Data is held in the grid, only the fixed size can be used
+    if (grid->width != GRID_FIXED_WIDTH || grid->height != GRID_FIXED_HEIGHT) {
+        return false;
+    }
+#else
+    // Attempt memory allocation
+    grid->data = malloc(get_grid_data_size(grid->width, grid->height));
+    if (grid->data == NULL) {
+        return false;
+    }
+#endif
+    if (clear) {
+        zero_grid_data(grid);
     }
+    return true;
 }
+
+
+bool allocate_arena_grid_data(grid_t* grid, arena_t* arena, bool clear) {
+#ifndef GRID_RUNTIME_SIZE
+    (void) arena; // Data is held in the grid
+    return allocate_grid_data(grid, clear);
+#else
+    grid->data = arena_alloc(arena, get_grid_data_size(grid->width, grid->height));
+    if (grid->data == NULL) {
+        return false;
+    }
+    if (clear) {
+        zero_grid_data(grid);
+    }
+    return true;
+#endif
+}
+
+
+void free_grid_data(grid_t* grid) {
+#ifdef GRID_RUNTIME_SIZE
+    free(grid->data);
+    grid->data = NULL;
+#else
+    (void) grid; // Data is held in the grid
+#endif
+}
+
+
+void zero_grid_data(grid_t* grid) {
+    bb_clear(&grid->shot);
+    bb_clear(&grid->destroyed);
+    bb_clear(&grid->occupied);
+    bb_clear(&grid->halo);
+    invalidate_grid_journal(grid);
+#ifdef GRID_RUNTIME_SIZE
+    if (grid->data == NULL) {
+        return;
+    }
+#endif
+    memset((void*) grid->data, 0, get_grid_data_size(grid_width(grid), grid_height(grid)));
+}
+
@@ -2,8 +2,12 @@
 #define GRID_H
 
 #include <stdio.h>
+#include <stdint.h>
 #include <stdbool.h>
 
+#include "bitboard.h"
+#include "arena.h"
+
 #define EMPTY_POS   (0)
 #define BLOCKED_POS ((g_data) (0xFFFF))
 
@@ -14,21 +18,132 @@
 #define IS_HIT(x)  (x & SHOT_POS && x & POS_DATA)
 #define IS_MISS(x) (x & SHOT_POS && !IS_HIT(x))
 
+/* Data plane formats, selected at compile time with -DGRID_STORAGE=... */
+#define GRID_STORAGE_BYTES   (0) // One byte per position
+#define GRID_STORAGE_NIBBLES (1) // Four bits per position
+
+#ifndef GRID_STORAGE
+#define GRID_STORAGE GRID_STORAGE_BYTES
+#endif
+
+#if GRID_STORAGE == GRID_STORAGE_NIBBLES
+#define PLANE_MASK (0x0F)
+#else
+#define PLANE_MASK (0xFF)
+#endif
+#define MAX_POS_DATA (PLANE_MASK) // Largest data a position can hold
+
+/* Dimensions of a grid, constants when fixed at compile time (see board_size.h) */
+#ifndef GRID_RUNTIME_SIZE
+#define grid_width(grid)  ((void) (grid), GRID_FIXED_WIDTH)
+#define grid_height(grid) ((void) (grid), GRID_FIXED_HEIGHT)
+#else
+#define grid_width(grid)  ((grid)->width)
+#define grid_height(grid) ((grid)->height)
+#endif
+
+/* Number of bytes in the data plane of a grid of the given size */
+#define GRID_PLANE_POSITIONS(width, height) ((width) * (height))
+#if GRID_STORAGE == GRID_STORAGE_NIBBLES
+#define GRID_DATA_SIZE(width, height) ((GRID_PLANE_POSITIONS(width, height) + 1) / 2)
+#else
+#define GRID_DATA_SIZE(width, height) (GRID_PLANE_POSITIONS(width, height))
+#endif
+
+/* Data plane layouts, selected at compile time with -DGRID_LAYOUT=... */
+#define GRID_LAYOUT_ROW_MAJOR (0) // Positions of a row are adjacent, matches the y then x scan loops
+#define GRID_LAYOUT_COL_MAJOR (1) // Positions of a column are adjacent
+
+#ifndef GRID_LAYOUT
+#define GRID_LAYOUT GRID_LAYOUT_ROW_MAJOR
+#endif
+
+/* Index offset between neighbouring positions along each axis */
+#if GRID_LAYOUT == GRID_LAYOUT_COL_MAJOR
+#define get_grid_stride_x(grid) (grid_height(grid))
+#define get_grid_stride_y(grid) (1)
+#else
+#define get_grid_stride_x(grid) (1)
+#define get_grid_stride_y(grid) (grid_width(grid))
+#endif
+
+/* Data plane index of a position, unchecked so only valid on the grid */
+#define get_grid_index(grid, x, y) ((x) * get_grid_stride_x(grid) + (y) * get_grid_stride_y(grid))
+
+/* Number of changed positions a grid remembers, must be a power of two */
+#ifndef GRID_JOURNAL_SIZE
+#define GRID_JOURNAL_SIZE (8)
+#endif
+
 /**
  * Type of data stored by a grid.
  */
 typedef int16_t g_data;
 
+/**
+ * Type of a data plane index or stride, wide enough for every position of the largest plane
+ * and for BLOCKED_POS. A fixed grid of at most 127 positions uses 8 bits.
+ */
+#if !defined(GRID_RUNTIME_SIZE) && GRID_PLANE_POSITIONS(GRID_FIXED_WIDTH, GRID_FIXED_HEIGHT) <= 127
+typedef int8_t grid_index_t;
+#else
+typedef int16_t grid_index_t;
+#endif
+
+/**
+ * Structure holding the most recently changed positions of a grid in a ring buffer.
+ * The epoch counts every change recorded, so an entry is at epoch % GRID_JOURNAL_SIZE.
+ */
+typedef struct {
+    int8_t x[GRID_JOURNAL_SIZE];
+    int8_t y[GRID_JOURNAL_SIZE];
+    uint16_t epoch;
+} grid_journal_t;
+
 /**
  * Structure representing a grid, a grid should be allocated data equivalent
- * to its grid/width.
+ * to its grid/width. Grid state is held as planes: a data plane (ship references)
+ * in the format given by GRID_STORAGE and bitboards for the flags. Data should be
+ * accessed through the grid functions and must not exceed MAX_POS_DATA.
  */
 typedef struct {
     uint8_t width;
     uint8_t height;
-    g_data* data;
+#ifndef GRID_RUNTIME_SIZE
+    uint8_t data[GRID_DATA_SIZE(GRID_FIXED_WIDTH, GRID_FIXED_HEIGHT)]; // Data plane
+#else
+    uint8_t* data;         // Data plane
+#endif
+    bitboard_t shot;       // Positions shot
+    bitboard_t destroyed;  // Positions marked destroyed
+    bitboard_t occupied;   // Positions with non-zero data (placed ships)
+    bitboard_t halo;       // Positions on or next to placed ships
+    grid_journal_t journal; // Positions recently changed
 } grid_t;
 
+/**
+ * Structure holding how far a consumer has read a grid's journal. Cursors start unsynced
+ * by setting grid to NULL.
+ */
+typedef struct {
+    grid_t* grid;   // Grid last synced with
+    uint16_t epoch; // Journal epoch read up to
+} grid_cursor_t;
+
+/**
+ * Iterator stepping along a row or column of a grid's data plane. Byte planes are walked
+ * by pointer, packed planes by index.
+ */
+typedef struct {
+#if GRID_STORAGE == GRID_STORAGE_NIBBLES
+    grid_t* grid;
+    grid_index_t index;
+#else
+    uint8_t* pos;
+#endif
+    grid_index_t stride;
+} grid_iter_t;
+
 /**
  * Print the raw data state of the given grid.
  *
@@ -87,20 +202,119 @@ void mark_shot(grid_t* grid, int8_t x, int8_t y);
 void mark_destroyed(grid_t* grid, int8_t x, int8_t y);
 
 /**
- * Allocate the required memory for a grid.
+ * Get the positions that have been shot and hold data (hit ships).
+ *
+ * @param grid Grid to query
+ * @param hits Bitboard to fill
+ */
+void get_hit_bitboard(grid_t* grid, bitboard_t* hits);
+
+/**
+ * Get the positions that have been shot and hold no data (misses).
+ *
+ * @param grid   Grid to query
+ * @param misses Bitboard to fill
+ */
+void get_miss_bitboard(grid_t* grid, bitboard_t* misses);
+
+/**
+ * Get the positions on the grid that have not been shot.
+ *
+ * @param grid   Grid to query
+ * @param unshot Bitboard to fill
+ */
+void get_unshot_bitboard(grid_t* grid, bitboard_t* unshot);
+
+/**
+ * Count the positions within a mask that have not been shot.
+ *
+ * @param  grid Grid to query
+ * @param  mask Positions to count within
+ * @return      Number of unshot positions
+ */
+uint16_t count_unshot_positions(grid_t* grid, bitboard_t* mask);
+
+/**
+ * Get the number of bytes of data required by a grid of the given size.
+ *
+ * @param  width  Grid width
+ * @param  height Grid height
+ * @return        Number of bytes
+ */
+uint16_t get_grid_data_size(uint8_t width, uint8_t height);
+
+/**
+ * Allocate the required memory for a grid. Grids with a fixed size hold their data so
+ * only the dimensions are checked.
  * 
- * @param grid  Grid with width/height set
- * @param clear Whether to clear the data to 0's
+ * @param  grid  Grid with width/height set
+ * @param  clear Whether to clear the data to 0's
+ * @return       Whether the grid can be used
  */
-void allocate_grid_data(grid_t* grid, bool clear);
+bool allocate_grid_data(grid_t* grid, bool clear);
 
 /**
- * Set all grid locations to 0.
+ * Allocate the required memory for a grid from an arena, the memory is released with the
+ * arena. Grids with a fixed size hold their data so only the dimensions are checked.
+ *
+ * @param  grid  Grid with width/height set
+ * @param  arena Arena to allocate from
+ * @param  clear Whether to clear the data to 0's
+ * @return       Whether the grid can be used
+ */
+bool allocate_arena_grid_data(grid_t* grid, arena_t* arena, bool clear);
+
+/**
+ * Free the memory allocated for a grid's data with allocate_grid_data.
+ *
+ * @param grid Grid to free data of
+ */
+void free_grid_data(grid_t* grid);
+
+/**
+ * Set all grid locations to 0, this includes clearing every plane.
  * 
  * @param grid Grid to update
  */
 void zero_grid_data(grid_t* grid);
 
+/**
+ * Invalidate every cursor of a grid's journal, used when positions change in bulk.
+ *
+ * @param grid Grid that changed
+ */
+void invalidate_grid_journal(grid_t* grid);
+
+/**
+ * Mark a cursor as having seen every change currently recorded by a grid.
+ *
+ * @param grid   Grid to sync with
+ * @param cursor Cursor to update
+ */
+void sync_grid_cursor(grid_t* grid, grid_cursor_t* cursor);
+
+/**
+ * Check whether every change to a grid since a cursor was synced is still in its journal.
+ * If not, the consumer must process the whole grid and sync again.
+ *
+ * @param  grid   Grid to check
+ * @param  cursor Cursor to check
+ * @return        Whether the changes since the cursor can be read
+ */
+bool is_grid_cursor_valid(grid_t* grid, grid_cursor_t* cursor);
+
+/**
+ * Get the next position changed since a cursor, advancing the cursor past it. The cursor
+ * must be valid. Positions may be returned more than once if changed more than once.
+ *
+ * @param  grid   Grid to read
+ * @param  cursor Cursor to read from
+ * @param  x      Return pointer for x coordinate
+ * @param  y      Return pointer for y coordinate
+ * @return        Whether there was a change to return
+ */
+bool next_grid_change(grid_t* grid, grid_cursor_t* cursor, int8_t* x, int8_t* y);
+
 /**
  * Get the grid date for a given x y coordinate. If the x y coordinate is not on the grid
  * a blocked position indicator is returned.
@@ -124,6 +338,8 @@ g_data get_grid_data(grid_t* grid, int8_t x, int8_t y);
 void set_grid_data(grid_t* grid, int8_t x, int8_t y, g_data data);
 
 
+/* Accessors called per position are inline so fixed grid dimensions fold into constants */
+
 /**
  * Map an x y coordinate to its respective data location for the given grid configuration.
  * If the coordinate cannot be mapped, a blocked position indicator is returned.
@@ -133,6 +349,94 @@ void set_grid_data(grid_t* grid, int8_t x, int8_t y, g_data data);
  * @param  y    y coordinate
  * @return      Mapped x y coordinate
  */
-int16_t map_grid_pos(grid_t* grid, int8_t x, int8_t y);
+static inline grid_index_t map_grid_pos(grid_t* grid, int8_t x, int8_t y) {
+    if (x >= 0 && x < grid_width(grid) && y >= 0 && y < grid_height(grid)) {
+        return get_grid_index(grid, x, y);
+    }
+    return BLOCKED_POS;
+}
+
+
+/**
+ * Get the data plane value at an index without any checks.
+ *
+ * @param  grid  Grid to read
+ * @param  index Index from get_grid_index
+ * @return       Data plane value
+ */
+static inline uint8_t get_plane_data(grid_t* grid, grid_index_t index) {
+#if GRID_STORAGE == GRID_STORAGE_NIBBLES
+    return (grid->data[index >> 1] >> ((index & 1) << 2)) & PLANE_MASK;
+#else
+    return grid->data[index];
+#endif
+}
+
+/**
+ * Set the data plane value at an index without any checks, the flag planes are not updated.
+ *
+ * @param grid  Grid to update
+ * @param index Index from get_grid_index, must be on the grid
+ * @param data  Data plane value
+ */
+static inline void set_plane_data(grid_t* grid, grid_index_t index, uint8_t data) {
+#if GRID_STORAGE == GRID_STORAGE_NIBBLES
+    uint8_t shift = (index & 1) << 2;
+    grid->data[index >> 1] = (grid->data[index >> 1] & ~(PLANE_MASK << shift)) | ((data & PLANE_MASK) << shift);
+#else
+    grid->data[index] = data;
+#endif
+}
+
+/**
+ * Get an iterator over a row of a grid, starting at x = 0. The iterator is unchecked, it
+ * must not be advanced past the end of the row.
+ *
+ * @param  grid Grid to iterate
+ * @param  y    Row to iterate, must be on the grid
+ * @return      Iterator at the start of the row
+ */
+static inline grid_iter_t grid_row_iter(grid_t* grid, int8_t y) {
+#if GRID_STORAGE == GRID_STORAGE_NIBBLES
+    grid_iter_t iter = {.grid = grid, .index = get_grid_index(grid, 0, y), .stride = get_grid_stride_x(grid)};
+#else
+    grid_iter_t iter = {.pos = &grid->data[get_grid_index(grid, 0, y)], .stride = get_grid_stride_x(grid)};
+#endif
+    return iter;
+}
+
+/**
+ * Get an iterator over a column of a grid, starting at y = 0. The iterator is unchecked, it
+ * must not be advanced past the end of the column.
+ *
+ * @param  grid Grid to iterate
+ * @param  x    Column to iterate, must be on the grid
+ * @return      Iterator at the start of the column
+ */
+static inline grid_iter_t grid_col_iter(grid_t* grid, int8_t x) {
+#if GRID_STORAGE == GRID_STORAGE_NIBBLES
+    grid_iter_t iter = {.grid = grid, .index = get_grid_index(grid, x, 0), .stride = get_grid_stride_y(grid)};
+#else
+    grid_iter_t iter = {.pos = &grid->data[get_grid_index(grid, x, 0)], .stride = get_grid_stride_y(grid)};
+#endif
+    return iter;
+}
+
+/**
+ * Read the data plane value at an iterator and advance it to the next position.
+ *
+ * @param  iter Iterator to read and advance
+ * @return      Data plane value
+ */
+static inline uint8_t grid_iter_next(grid_iter_t* iter) {
+#if GRID_STORAGE == GRID_STORAGE_NIBBLES
+    uint8_t data = get_plane_data(iter->grid, iter->index);
+    iter->index += iter->stride;
+#else
+    uint8_t data = *iter->pos;
+    iter->pos += iter->stride;
+#endif
+    return data;
+}
 
 #endif // GRID_H
\ No newline at end of file
@@ -5,16 +5,20 @@
 #include "lafortuna/lcd/lcd.h"
 #include "lafortuna/drawing/drawing.h"
 
+/* Labels for rows counting up from the bottom, one character for up to GRID_MAX_SIZE rows */
+static const char row_labels[] PROGMEM = "0123456789ABCDEFGHIJKLMNOP";
 
 /* Function Prototypes */
 void get_ship_constraints(grid_t* grid, ship_t* ship, draw_props_t* draw_props, 
     uint16_t* draw_x, uint16_t* draw_y, uint16_t* draw_width, uint16_t* draw_height);
 void pad_draw_area(int8_t pad_x, int8_t pad_y, uint16_t* x, uint16_t* y, 
     uint16_t* width, uint16_t* height);
+uint8_t get_label_step(int16_t pos_size, uint8_t label_size);
+void redraw_ships(player_t* player, uint16_t redraw, bitboard_t* markers, draw_props_t* draw_props);
 
 
-void draw_title(char* title, draw_props_t* draw_props) {
-    uint8_t len = strlen(title);
+void draw_title(PGM_P title, draw_props_t* draw_props) {
+    uint8_t len = strlen_P(title);
 
     // Clear current
     rectangle title_area = {
@@ -27,13 +31,18 @@ void draw_title(char* title, draw_props_t* draw_props) {
     display.x = draw_props->x + (draw_props->width - len * FONT_WIDTH) / 2;
     display.y = title_area.top;
     display.foreground = TEXT_COL;
-    display_string(title);
+    display_string_P(title);
 }
 
 
 void draw_grid(grid_t* grid, draw_props_t* draw_props) {
     int16_t pos_draw_width = draw_props->width / (grid->width + 1);
     int16_t pos_draw_height = draw_props->height / (grid->height + 1);
+    // Squares narrower than a character only have every n'th axis position labelled
+    uint8_t label_step_x = get_label_step(pos_draw_width, FONT_WIDTH + 1);
+    uint8_t label_step_y = get_label_step(pos_draw_height, FONT_HEIGHT + 1);
+    int16_t label_x = pos_draw_width > FONT_WIDTH ? (pos_draw_width - FONT_WIDTH) / 2 : 0;
+    int16_t label_y = pos_draw_height > FONT_HEIGHT ? pos_draw_height / 2 : 0;
 
     for (int8_t y = 0; y <= grid->height; y++) {
         for (int8_t x = -1; x < grid->width; x++) {
@@ -47,13 +56,14 @@ void draw_grid(grid_t* grid, draw_props_t* draw_props) {
                     pos_draw_height, 
                     (GRID_BORDER));
             } else {
-                display.x += (pos_draw_width - FONT_WIDTH) / 2 ;
-                display.y += (pos_draw_height) / 2;
+                display.x += label_x;
+                display.y += label_y;
                 display.foreground = TEXT_COL;
-                if (x == -1 && y != grid->height) {
-                    display_char("0123456789ABCDEF"[grid->height - y - 1]);
-                } else if (y == grid->height && x != -1) {
-                    display_char("ABCDEFGHIJKLMNO"[x]);
+                uint8_t row = grid->height - y - 1;
+                if (x == -1 && y != grid->height && row % label_step_y == 0) {
+                    display_char(pgm_read_byte(&row_labels[row]));
+                } else if (y == grid->height && x != -1 && x % label_step_x == 0) {
+                    display_char('A' + x);
                 }
             }
         }
@@ -62,11 +72,25 @@ void draw_grid(grid_t* grid, draw_props_t* draw_props) {
 
 
 void draw_shot_overlay(grid_t* grid, draw_props_t* draw_props) {
-    for (int8_t y = 0; y < grid->height; y++) {
-        for (int8_t x = 0; x < grid->width; x++) {
-            draw_shot(grid, x, y, draw_props);
-        }
-    } 
+    // Only visit shot positions
+    bitboard_t shots = grid->shot;
+    uint8_t x, y = 0;
+    while (bb_next(&shots, grid->height, &x, &y)) {
+        draw_shot(grid, x, y, draw_props);
+    }
+    sync_grid_cursor(grid, &draw_props->shots);
+}
+
+
+void draw_shot_changes(grid_t* grid, draw_props_t* draw_props) {
+    if (!is_grid_cursor_valid(grid, &draw_props->shots)) {
+        draw_shot_overlay(grid, draw_props);
+        return;
+    }
+    int8_t x, y;
+    while (next_grid_change(grid, &draw_props->shots, &x, &y)) {
+        draw_shot(grid, x, y, draw_props);
+    }
 }
 
 
@@ -80,8 +104,8 @@ void draw_shot(grid_t* grid, uint8_t x, uint8_t y, draw_props_t* draw_props) {
     uint16_t draw_height = pos_draw_width;
     uint16_t draw_width  = pos_draw_height;
 
-    int8_t x_padding = pos_draw_width / 1.6;
-    int8_t y_padding = pos_draw_height / 1.6;
+    int8_t x_padding = pos_draw_width * 5 / 8;
+    int8_t y_padding = pos_draw_height * 5 / 8;
     pad_draw_area(x_padding, y_padding, &draw_x, &draw_y, &draw_width, &draw_height);
 
     uint16_t bg_colour;
@@ -141,34 +165,110 @@ void draw_ship(grid_t* grid, ship_t* ship, draw_props_t* draw_props) {
 }
 
 
+void update_preview_overlay(player_t* player, bitboard_t* shown, bitboard_t* shade, draw_props_t* draw_props) {
+    grid_t* grid = player->grid;
+    int16_t pos_draw_width = draw_props->width / (grid->width + 1);
+    int16_t pos_draw_height = draw_props->height / (grid->height + 1);
+    // Ships whose squares have been cleared, by bit (ref - 1)
+    uint16_t redraw = 0;
+
+    for (int8_t y = 0; y < grid->height; y++) {
+        bb_row_t changed = shown->rows[y] ^ shade->rows[y];
+        for (int8_t x = 0; changed; x++, changed >>= 1) {
+            if (!(changed & 1)) {
+                continue;
+            }
+            // Fill inside the grid lines so selections are unaffected
+            rectangle square;
+            square.left = draw_props->x + (x + 1) * pos_draw_width + 1;
+            square.right = square.left + pos_draw_width - 2;
+            square.top = draw_props->y + y * pos_draw_height + 1;
+            square.bottom = square.top + pos_draw_height - 2;
+            bool shaded = bb_test(shade, x, y);
+            fill_rectangle(square, shaded ? PREVIEW_COL : display.background);
+
+            int8_t ship_idx = (get_grid_data(grid, x, y) & POS_DATA) - 1;
+            if (!shaded && ship_idx >= 0) {
+                redraw |= 1 << ship_idx;
+            }
+        }
+        shown->rows[y] = shade->rows[y];
+    }
+
+    for (uint8_t ship_idx = 0; redraw; ship_idx++, redraw >>= 1) {
+        if (redraw & 1) {
+            draw_ship(grid, &player->ships[ship_idx], draw_props);
+        }
+    }
+}
+
+
 void draw_selection(grid_t* grid, int8_t x, int8_t y, draw_props_t* draw_props, uint16_t colour) {
     int16_t pos_draw_width = draw_props->width / (grid->width + 1);
     int16_t pos_draw_height = draw_props->height / (grid->height + 1);
     uint16_t draw_x = draw_props->x + (x+1) * pos_draw_width;
     uint16_t draw_y = draw_props->y + y * pos_draw_height;
-    stroke_line(draw_x, draw_y, draw_x + pos_draw_width, draw_y, colour);
-    stroke_line(draw_x, draw_y, draw_x, draw_y + pos_draw_height, colour);
-    stroke_line(draw_x + pos_draw_width, draw_y, draw_x + pos_draw_width, draw_y + pos_draw_height, colour);
-    stroke_line(draw_x, draw_y + pos_draw_height, draw_x + pos_draw_width, draw_y + pos_draw_height, colour);
+    outline_rectangle(draw_x, draw_y, pos_draw_width, pos_draw_height, colour);
 }
 
 
-void clear_selection(player_t* player, int8_t x, int8_t y, draw_props_t* draw_props) {
-    draw_selection(player->grid, x, y, draw_props, GRID_BORDER);
-    draw_shot_overlay(player->grid, draw_props);
-    // Ships must be redrawn if selection is drawn over them
-    g_data sel_data = get_grid_data(player->grid, x, y);
-    int8_t ship_idx = (sel_data & POS_DATA) - 1;
-    if (ship_idx >= 0) {
-        ship_t* ship = &player->ships[ship_idx];
-        draw_ship(player->grid, ship, draw_props);
-        int8_t ship_x = ship->x;
-        int8_t ship_y = ship->y;
-        for (uint8_t i = 0; i < ship->length; i++) {
-            draw_shot(player->grid, ship_x, ship_y, draw_props);
-            move_x_y(&ship_x, &ship_y, ship->dir);
+void damage_grid_pos(draw_props_t* draw_props, int8_t x, int8_t y) {
+    bb_set(&draw_props->damage, x, y);
+}
+
+
+void select_grid_pos(draw_props_t* draw_props, int8_t x, int8_t y, uint16_t colour) {
+    if (draw_props->sel_x != NO_SELECTION) {
+        damage_grid_pos(draw_props, draw_props->sel_x, draw_props->sel_y);
+    }
+    draw_props->sel_x = x;
+    draw_props->sel_y = y;
+    draw_props->sel_colour = colour;
+}
+
+
+void flush_grid_damage(player_t* player, draw_props_t* draw_props) {
+    grid_t* grid = player->grid;
+    int16_t pos_draw_width = draw_props->width / (grid->width + 1);
+    int16_t pos_draw_height = draw_props->height / (grid->height + 1);
+    // Ships covering a repainted square, by bit (ref - 1)
+    uint16_t redraw = 0;
+
+    // Square layer
+    bitboard_t damage = draw_props->damage;
+    uint8_t x, y = 0;
+    while (bb_next(&damage, grid->height, &x, &y)) {
+        stroke_rectangle(
+            draw_props->x + (x + 1) * pos_draw_width,
+            draw_props->y + y * pos_draw_height,
+            pos_draw_width,
+            pos_draw_height,
+            (GRID_BORDER));
+        int8_t ship_idx = get_ship_idx(get_grid_data(grid, x, y) & POS_DATA);
+        if (ship_idx >= 0) {
+            redraw |= 1 << ship_idx;
         }
     }
+
+    // Ship layer, a redrawn ship covers the shot markers along it
+    redraw_ships(player, redraw, &draw_props->damage, draw_props);
+
+    // Shot layer, consumes the damage
+    y = 0;
+    while (bb_next(&draw_props->damage, grid->height, &x, &y)) {
+        draw_shot(grid, x, y, draw_props);
+    }
+
+    // Selection layer, its stroke is shared with the neighbouring squares
+    if (draw_props->sel_x != NO_SELECTION) {
+        draw_selection(grid, draw_props->sel_x, draw_props->sel_y, draw_props, draw_props->sel_colour);
+    }
+}
+
+
+void clear_selection(player_t* player, draw_props_t* draw_props) {
+    select_grid_pos(draw_props, NO_SELECTION, NO_SELECTION, GRID_BORDER);
+    flush_grid_damage(player, draw_props);
 }
 
 
@@ -176,17 +276,34 @@ void draw_ship_selection(grid_t* grid, ship_t* ship, draw_props_t* draw_props, u
     uint16_t draw_x, draw_y, draw_width, draw_height;
     get_ship_constraints(grid, ship, draw_props, &draw_x, &draw_y, &draw_width, &draw_height);
 
-    stroke_line(draw_x, draw_y, draw_x + draw_width, draw_y, colour);
-    stroke_line(draw_x, draw_y, draw_x, draw_y + draw_height, colour);
-    stroke_line(draw_x + draw_width, draw_y, draw_x + draw_width, draw_y + draw_height, colour);
-    stroke_line(draw_x, draw_y + draw_height, draw_x + draw_width, draw_y + draw_height, colour);
+    outline_rectangle(draw_x, draw_y, draw_width, draw_height, colour);
 }
 
 
 void clear_ship_selection(player_t* player, ship_t* cur_ship, draw_props_t* draw_props) {
-    draw_ship_selection(player->grid, cur_ship, draw_props, GRID_BORDER);
-    draw_ships(player->grid, player->ships, player->ship_count, draw_props);
-    draw_shot_overlay(player->grid, draw_props);
+    grid_t* grid = player->grid;
+    draw_ship_selection(grid, cur_ship, draw_props, GRID_BORDER);
+
+    // Only ships on the squares under the outline can have been drawn over
+    uint16_t redraw = 0;
+    int8_t x = cur_ship->x;
+    int8_t y = cur_ship->y;
+    for (uint8_t i = 0; i < cur_ship->length; i++) {
+        g_data data = get_grid_data(grid, x, y);
+        int8_t ship_idx = get_ship_idx(data & POS_DATA);
+        if (data != BLOCKED_POS && ship_idx >= 0) {
+            redraw |= 1 << ship_idx;
+        }
+        move_x_y(&x, &y, cur_ship->dir);
+    }
+
+    bitboard_t markers;
+    bb_clear(&markers);
+    redraw_ships(player, redraw, &markers, draw_props);
+    uint8_t marker_x, marker_y = 0;
+    while (bb_next(&markers, grid->height, &marker_x, &marker_y)) {
+        draw_shot(grid, marker_x, marker_y, draw_props);
+    }
 }
 
 /**
@@ -252,3 +369,47 @@ void pad_draw_area(int8_t pad_x, int8_t pad_y, uint16_t* draw_x, uint16_t* draw_
     *draw_width -= pad_x;
     *draw_height -= pad_y;
 }
+
+
+/**
+ * Redraw ships, if drawing properties indicate to draw them, and mark the positions they
+ * cover as their shot markers will have been drawn over.
+ *
+ * @param player     Player who's ships are on the grid
+ * @param redraw     Ships to redraw, by bit (ref - 1)
+ * @param markers    Bitboard to set the covered positions on
+ * @param draw_props Dimensions for mapping to drawn grid
+ */
+void redraw_ships(player_t* player, uint16_t redraw, bitboard_t* markers, draw_props_t* draw_props) {
+    if (!draw_props->ships) {
+        return;
+    }
+    for (uint8_t ship_idx = 0; redraw; ship_idx++, redraw >>= 1) {
+        if (!(redraw & 1)) {
+            continue;
+        }
+        ship_t* ship = &player->ships[ship_idx];
+        draw_ship(player->grid, ship, draw_props);
+        int8_t ship_x = ship->x;
+        int8_t ship_y = ship->y;
+        for (uint8_t i = 0; i < ship->length; i++) {
+            bb_set(markers, ship_x, ship_y);
+            move_x_y(&ship_x, &ship_y, ship->dir);
+        }
+    }
+}
+
+
+/**
+ * Get how often axis positions can be labelled without labels overlapping.
+ *
+ * @param  pos_size   Size of a grid position along the axis
+ * @param  label_size Space needed by a label along the axis
+ * @return            Number of positions per label
+ */
+uint8_t get_label_step(int16_t pos_size, uint8_t label_size) {
+    if (pos_size <= 0) {
+        return label_size;
+    }
+    return pos_size >= label_size ? 1 : (label_size + pos_size - 1) / pos_size;
+}
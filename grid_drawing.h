@@ -20,6 +20,7 @@
 #define SHIP_BG        (0xD6BA)
 
 #define VALID_SEL      (0x4FE0)
+#define PREVIEW_COL    (0x0200)
 #define INVALID_SEL    (0xF800)
 #define GRID_BORDER    (0xEF5D)
 
@@ -28,7 +29,10 @@
 #define FONT_HEIGHT (7)
 #define LINE_FEED_HEIGHT (9)
 
-#define TITLE_HEIGHT (FONT_HEIGHT * 1.5)
+#define TITLE_HEIGHT (FONT_HEIGHT * 3 / 2)
+
+/* Selection coordinate used when no position is selected */
+#define NO_SELECTION (-1)
 
 /**
  * Structure for configuring positioning, sizing and what is actually
@@ -40,16 +44,22 @@ typedef struct {
     uint16_t width;
     uint16_t height;
     bool ships;
+    bool preview;
+    grid_cursor_t shots; // Grid changes the shot overlay has been drawn up to
+    bitboard_t damage;   // Positions to repaint at the next flush_grid_damage
+    int8_t sel_x;        // Selected position, NO_SELECTION if there is none
+    int8_t sel_y;
+    uint16_t sel_colour;
 } draw_props_t;
 
 
 /**
  * Centre a string a above a drawn grid.
  * 
- * @param title      Title to display
+ * @param title      Title to display, in program memory
  * @param draw_props Dimensions for mapping to drawn grid
  */
-void draw_title(char* title, draw_props_t* draw_props);
+void draw_title(PGM_P title, draw_props_t* draw_props);
 
 /**
  * Draw a grid into the given area, this includes a LHS number axis and a bottom letter
@@ -64,13 +74,22 @@ void draw_grid(grid_t* grid, draw_props_t* draw_props);
 
 
 /**
- * Draw the shot contents for all grid positions using draw_shot.
+ * Draw the shot contents for all shot grid positions using draw_shot.
  * 
  * @param grid       Grid to use for reference information
  * @param draw_props Dimensions for mapping to drawn grid
  */
 void draw_shot_overlay(grid_t* grid, draw_props_t* draw_props);
 
+/**
+ * Draw the shots at positions changed since the shot overlay was last drawn with the given
+ * draw properties. The whole overlay is drawn if the changes are no longer known.
+ *
+ * @param grid       Grid to use for reference information
+ * @param draw_props Dimensions for mapping to drawn grid, its shot cursor is updated
+ */
+void draw_shot_changes(grid_t* grid, draw_props_t* draw_props);
+
 /**
  * Draw the shot contents of a single grid position, reflecting whether the the grid
  * indicates this as a hit or miss. If there is no shot, nothing is drawn.
@@ -102,6 +121,17 @@ void draw_ships(grid_t* grid, ship_t ships[], uint8_t ship_count, draw_props_t *
  */
 void draw_ship(grid_t* grid, ship_t* ship, draw_props_t* draw_props);
 
+/**
+ * Update an overlay that shades the inside of grid squares. Only squares whose shading differs from
+ * the shown overlay are redrawn, any ships on squares that are cleared are redrawn on top.
+ *
+ * @param player     Player who's ships are on the grid (for redrawing)
+ * @param shown      Squares currently shaded, updated to match shade
+ * @param shade      Squares that should be shaded
+ * @param draw_props Dimensions for mapping to drawn grid
+ */
+void update_preview_overlay(player_t* player, bitboard_t* shown, bitboard_t* shade, draw_props_t* draw_props);
+
 /**
  * Draw a single selection square, this uses a stroke so contents of squares will not be overwritten.
  * However, contents that goes over grid boundaries such as ships will need to be redrawn if they
@@ -116,16 +146,43 @@ void draw_ship(grid_t* grid, ship_t* ship, draw_props_t* draw_props);
 void draw_selection(grid_t* grid, int8_t x, int8_t y, draw_props_t* draw_props, uint16_t colour);
 
 /**
- * Clear a single selection square. The functionality involves redrawing a grid coloured square over
- * any previous selections. As this may cause overlap on ships, any affected ships are redrawn 
- * alongside their shots, this is localised for performance.
- * 
+ * Mark a grid position as needing to be repainted at the next flush_grid_damage.
+ *
+ * @param draw_props Drawing properties holding the damage
+ * @param x          x coordinate of the position
+ * @param y          y coordinate of the position
+ */
+void damage_grid_pos(draw_props_t* draw_props, int8_t x, int8_t y);
+
+/**
+ * Move the selection square to a position. Nothing is drawn, the previously selected
+ * position is damaged and the new selection is drawn at the next flush_grid_damage.
+ *
+ * @param draw_props Drawing properties holding the selection
+ * @param x          x coordinate to select, NO_SELECTION to remove the selection
+ * @param y          y coordinate to select
+ * @param colour     Colour to draw selection
+ */
+void select_grid_pos(draw_props_t* draw_props, int8_t x, int8_t y, uint16_t colour);
+
+/**
+ * Repaint the damaged positions of a grid, layer by layer: the square itself, any ships
+ * covering it, the shot markers of those positions and ships, then the selection on top.
+ * Only damaged positions are visited so the cost does not grow with the number of shots.
+ * The preview overlay is not repainted. Damage is cleared afterwards.
+ *
+ * @param player     Player who's ships are on the grid (for redrawing)
+ * @param draw_props Dimensions for mapping to drawn grid (ships not redrawn if hidden)
+ */
+void flush_grid_damage(player_t* player, draw_props_t* draw_props);
+
+/**
+ * Remove the selection square and repaint the position it covered.
+ *
  * @param player     Player who's ships are on the grid (for redrawing)
- * @param x          x coordinate to clear selection at
- * @param y          y coordinate to clear selection at
  * @param draw_props Dimensions for mapping to drawn grid (ships not redrawn if hidden)
  */
-void clear_selection(player_t* player, int8_t x, int8_t y, draw_props_t* draw_props);
+void clear_selection(player_t* player, draw_props_t* draw_props);
 
 /**
  * Draw a selection square/rectangle that covers the whole, this uses a stroke so contents of squares
@@ -140,9 +197,9 @@ void clear_selection(player_t* player, int8_t x, int8_t y, draw_props_t* draw_pr
 void draw_ship_selection(grid_t* grid, ship_t* ship, draw_props_t* draw_props, uint16_t colour);
 
 /**
- * Clear a ship selection square/rectangle. The functionality involves redrawing a grid coloured 
- * square/rectangle over any previous selections. As this may cause overlap on ships, all ships 
- * and shots are redrawn (FIXME: Only redraw required).
+ * Clear a ship selection square/rectangle. The functionality involves redrawing a grid coloured
+ * square/rectangle over any previous selections. As this may cause overlap on ships, ships on the
+ * squares under the selection are redrawn alongside their shots, other ships are untouched.
  * 
  * @param player     Player who's ships are on the grid (for redrawing)
  * @param cur_ship   Ship selection to clear
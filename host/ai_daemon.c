@@ -0,0 +1,162 @@
+/*
+ * Reference host engine for the serial AI link (see link_proto.h).
+ *
+ * Reads shot request frames from a serial device, chooses a shot and replies.
+ * The strategy here mirrors the on-board density AI so results can be compared;
+ * heavier strategies can replace choose_shot without touching the protocol.
+ *
+ * Usage: ai_daemon <device> [seed]
+ *
+ * For testing without a board, create a pseudo-terminal pair, e.g.
+ *   socat -d -d pty,raw,echo=0 pty,raw,echo=0
+ * and run the daemon on one end whilst driving the other.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+#include "grid.h"
+#include "ship.h"
+#include "ai.h"
+#include "link_proto.h"
+
+int open_link(const char* path);
+bool choose_shot(grid_t* grid, ship_t ships[], uint8_t ship_count, int8_t* x, int8_t* y);
+bool handle_frame(int fd, link_parser_t* parser);
+
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <device> [seed]\n", argv[0]);
+        return 2;
+    }
+    srand(argc > 2 ? strtoul(argv[2], NULL, 0) : 1);
+
+    int fd = open_link(argv[1]);
+    if (fd < 0) {
+        fprintf(stderr, "%s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+
+    link_parser_t parser;
+    link_parser_reset(&parser);
+    uint8_t buf[64];
+    while (true) {
+        ssize_t received = read(fd, buf, sizeof(buf));
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("read");
+            break;
+        }
+        if (received == 0) {
+            // Other end of a pty has closed
+            break;
+        }
+        for (ssize_t i = 0; i < received; i++) {
+            if (link_parse_byte(&parser, buf[i])) {
+                handle_frame(fd, &parser);
+            }
+        }
+    }
+    close(fd);
+    return 0;
+}
+
+/**
+ * Open a serial device in raw mode at the link baud rate.
+ *
+ * @param  path Device to open
+ * @return      File descriptor, negative on failure
+ */
+int open_link(const char* path) {
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        return fd;
+    }
+    struct termios tio;
+    if (tcgetattr(fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        cfsetispeed(&tio, B38400);
+        cfsetospeed(&tio, B38400);
+        tio.c_cc[VMIN] = 1;
+        tio.c_cc[VTIME] = 0;
+        tcsetattr(fd, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+/**
+ * Respond to a complete frame held by the parser. Only shot requests are answered.
+ *
+ * @param  fd     Link to reply on
+ * @param  parser Parser holding a valid frame
+ * @return        Whether a reply was sent
+ */
+bool handle_frame(int fd, link_parser_t* parser) {
+    if (parser->type != LinkShotRequest) {
+        return false;
+    }
+    grid_t grid = {.width = 0, .height = 0, .data = NULL};
+    ship_t ships[LINK_MAX_SHIPS];
+    uint8_t ship_count;
+    placement_rule_t rule;
+    bool sent = false;
+    if (link_decode_request(parser->payload, parser->length, &grid, ships, &ship_count, &rule)) {
+        // The board's rule decides which positions next to destroyed ships are possible
+        placement_rule = rule;
+        int8_t x, y;
+        if (choose_shot(&grid, ships, ship_count, &x, &y)) {
+            uint8_t frame[LINK_FRAME_SIZE(2)];
+            uint16_t length = link_encode_reply(frame, x, y);
+            sent = write(fd, frame, length) == (ssize_t) length;
+            fprintf(stderr, "%dx%d board: shot (%d, %d)\n", grid.width, grid.height, x, y);
+        }
+    } else {
+        fprintf(stderr, "malformed shot request (%d bytes)\n", parser->length);
+    }
+    free_grid_data(&grid);
+    return sent;
+}
+
+/**
+ * Choose the position to shoot on a decoded board. The most probable position is chosen,
+ * randomly if multiple positions share the maximum.
+ *
+ * @param  grid       Decoded target grid
+ * @param  ships      Decoded ships
+ * @param  ship_count Number of ships
+ * @param  x          Return pointer for x coordinate
+ * @param  y          Return pointer for y coordinate
+ * @return            Whether a shot could be chosen
+ */
+bool choose_shot(grid_t* grid, ship_t ships[], uint8_t ship_count, int8_t* x, int8_t* y) {
+    prob_grid_t prob_grid = {.width = grid->width, .height = grid->height};
+    allocate_prob_grid(&prob_grid);
+    if (prob_grid.weights == NULL) {
+        return false;
+    }
+    gen_probability_grid(grid, &prob_grid, ships, ship_count);
+
+    int16_t max;
+    uint16_t occurrence = get_max_probability(&prob_grid, &max);
+    uint16_t ongoing = 0;
+    uint16_t shot = occurrence > 0 ? 1 + rand() % occurrence : 0;
+    for (*y = 0; *y < grid->height; (*y)++) {
+        for (*x = 0; *x < grid->width; (*x)++) {
+            if (get_prob(&prob_grid, *x, *y) == max && ++ongoing == shot) {
+                free(prob_grid.weights);
+                return true;
+            }
+        }
+    }
+    free(prob_grid.weights);
+    return false;
+}
@@ -0,0 +1,185 @@
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "corpus.h"
+#include "rng.h"
+
+/**
+ * Structure holding the work of a single generator thread.
+ */
+typedef struct {
+    const corpus_spec_t* spec;
+    uint32_t seed;
+    uint32_t first;
+    uint32_t last;
+    corpus_ship_t* records;
+    uint32_t failures;
+    bool threaded;
+} corpus_job_t;
+
+void* corpus_worker(void* arg);
+
+
+uint32_t corpus_generate(const corpus_spec_t* spec, uint32_t seed, uint32_t count, unsigned threads,
+    corpus_ship_t* records) {
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? cpus : 1;
+    }
+    if (threads > count) {
+        threads = count > 0 ? count : 1;
+    }
+
+    corpus_job_t* jobs = calloc(threads, sizeof(corpus_job_t));
+    pthread_t* workers = calloc(threads, sizeof(pthread_t));
+    if (jobs == NULL || workers == NULL) {
+        free(jobs);
+        free(workers);
+        return count;
+    }
+
+    // Split into contiguous ranges, one per thread
+    placement_rule_t caller_rule = placement_rule;
+    placement_rule = spec->rule;
+    uint32_t failures = 0;
+    for (unsigned t = 0; t < threads; t++) {
+        jobs[t] = (corpus_job_t) {
+            .spec = spec, .seed = seed, .records = records,
+            .first = (uint64_t) count * t / threads,
+            .last = (uint64_t) count * (t + 1) / threads
+        };
+        jobs[t].threaded = pthread_create(&workers[t], NULL, corpus_worker, &jobs[t]) == 0;
+        if (!jobs[t].threaded) {
+            // Run on this thread instead
+            corpus_worker(&jobs[t]);
+        }
+    }
+    for (unsigned t = 0; t < threads; t++) {
+        if (jobs[t].threaded) {
+            pthread_join(workers[t], NULL);
+        }
+        failures += jobs[t].failures;
+    }
+    placement_rule = caller_rule;
+    free(jobs);
+    free(workers);
+    return failures;
+}
+
+
+bool corpus_write(const char* path, const corpus_spec_t* spec, uint32_t seed, uint32_t count,
+    const corpus_ship_t* records) {
+    corpus_header_t header = {
+        .magic = CORPUS_MAGIC, .version = CORPUS_VERSION,
+        .width = spec->width, .height = spec->height, .ship_count = spec->ship_count,
+        .record_size = spec->ship_count * sizeof(corpus_ship_t), .mode = spec->mode,
+        .rule = spec->rule, .seed = seed, .count = count
+    };
+    memcpy(header.lengths, spec->lengths, sizeof(header.lengths));
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(records, header.record_size, count, file) == count;
+    return fclose(file) == 0 && written;
+}
+
+
+bool corpus_map(const char* path, corpus_t* corpus) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t) st.st_size >= sizeof(corpus_header_t)) {
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    // The version check also rejects a corpus written with the other byte order, whose header
+    // fields cannot be used in place
+    const corpus_header_t* header = map;
+    size_t expected = sizeof(corpus_header_t) + (size_t) header->record_size * header->count;
+    if (memcmp(header->magic, CORPUS_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != CORPUS_VERSION || header->ship_count > CORPUS_MAX_SHIPS ||
+        header->record_size != header->ship_count * sizeof(corpus_ship_t) ||
+        expected > (size_t) st.st_size) {
+        munmap(map, st.st_size);
+        return false;
+    }
+    corpus->header = header;
+    corpus->records = (const corpus_ship_t*) (header + 1);
+    corpus->map_size = st.st_size;
+    return true;
+}
+
+
+void corpus_unmap(corpus_t* corpus) {
+    munmap((void*) corpus->header, corpus->map_size);
+    corpus->header = NULL;
+    corpus->records = NULL;
+}
+
+
+const corpus_ship_t* corpus_layout(const corpus_t* corpus, uint32_t idx) {
+    return corpus->records + (size_t) idx * corpus->header->ship_count;
+}
+
+
+void corpus_unpack_ship(const corpus_ship_t* entry, ship_t* ship) {
+    ship->x = entry->x;
+    ship->y = entry->y_dir & CORPUS_Y_MASK;
+    ship->dir = entry->y_dir >> CORPUS_DIR_SHIFT;
+    ship->placed = true;
+}
+
+/**
+ * Generate the range of layouts assigned to a job. Each thread owns its grid and
+ * every layout has its own random stream.
+ *
+ * @param  arg Job to run (corpus_job_t)
+ * @return     NULL
+ */
+void* corpus_worker(void* arg) {
+    corpus_job_t* job = arg;
+    const corpus_spec_t* spec = job->spec;
+    grid_t grid = {.width = spec->width, .height = spec->height};
+    if (!allocate_grid_data(&grid, false)) {
+        job->failures = job->last - job->first;
+        return NULL;
+    }
+
+    ship_t ships[CORPUS_MAX_SHIPS];
+    rng_t rng;
+    for (uint32_t idx = job->first; idx < job->last; idx++) {
+        for (uint8_t s = 0; s < spec->ship_count; s++) {
+            ships[s] = (ship_t) {.length = spec->lengths[s], SHIP_DEFAULTS};
+        }
+        zero_grid_data(&grid);
+        rng_seed_stream(&rng, job->seed, idx);
+
+        corpus_ship_t* record = job->records + (size_t) idx * spec->ship_count;
+        if (!is_layout_placed(sample_layout(&grid, ships, spec->ship_count, spec->mode, &rng))) {
+            memset(record, 0, spec->ship_count * sizeof(corpus_ship_t));
+            job->failures++;
+            continue;
+        }
+        for (uint8_t s = 0; s < spec->ship_count; s++) {
+            record[s].x = ships[s].x;
+            record[s].y_dir = (ships[s].y & CORPUS_Y_MASK) | (ships[s].dir << CORPUS_DIR_SHIFT);
+        }
+    }
+    free_grid_data(&grid);
+    return NULL;
+}
@@ -0,0 +1,138 @@
+/*
+ * Layout corpora: large fixed sets of ship layouts for reproducible AI benchmarks.
+ *
+ * A corpus file is a corpus_header_t followed by `count` fixed size records of
+ * `ship_count` corpus_ship_t entries (in fleet order). Records are single bytes, the
+ * multi-byte header fields are in the byte order of the host that wrote the file so a
+ * mapped file can be used in place without parsing. The version doubles as a byte-order
+ * mark: corpus_map rejects a file written on a host of the other byte order.
+ */
+
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "grid.h"
+#include "ship.h"
+#include "layout.h"
+
+#define CORPUS_MAGIC     "LBLC"
+#define CORPUS_VERSION   (1) // Also the byte-order mark, so must differ from itself byte swapped
+#define CORPUS_MAX_SHIPS (12)
+
+/* Packing of y and direction into corpus_ship_t.y_dir */
+#define CORPUS_Y_MASK    (0x3F)
+#define CORPUS_DIR_SHIFT (6)
+
+/**
+ * Structure describing the board and fleet to generate layouts for.
+ */
+typedef struct {
+    uint8_t width;
+    uint8_t height;
+    uint8_t ship_count;
+    uint8_t lengths[CORPUS_MAX_SHIPS];
+    layout_mode_t mode;
+    placement_rule_t rule;
+} corpus_spec_t;
+
+/**
+ * On-disk corpus header (32 bytes).
+ */
+typedef struct {
+    char magic[4];
+    uint16_t version;
+    uint8_t width;
+    uint8_t height;
+    uint8_t ship_count;
+    uint8_t record_size;
+    uint8_t mode;
+    uint8_t rule;
+    uint32_t seed;
+    uint32_t count;
+    uint8_t lengths[CORPUS_MAX_SHIPS];
+} corpus_header_t;
+
+/**
+ * On-disk placement of a single ship.
+ */
+typedef struct {
+    uint8_t x;
+    uint8_t y_dir;
+} corpus_ship_t;
+
+/**
+ * Structure referencing a memory-mapped corpus file.
+ */
+typedef struct {
+    const corpus_header_t* header;
+    const corpus_ship_t* records;
+    size_t map_size;
+} corpus_t;
+
+/**
+ * Generate layouts in parallel. Layout n is drawn from a stream seeded by (seed, n) so
+ * output is identical for any number of threads. The spec's placement rule is applied
+ * globally for the duration of the call and the caller's rule restored afterwards.
+ *
+ * @param  spec    Board and fleet to generate for
+ * @param  seed    Base seed
+ * @param  count   Number of layouts to generate
+ * @param  threads Number of worker threads (0 uses one per online CPU)
+ * @param  records Output of count * spec->ship_count entries
+ * @return         Number of layouts that could not be placed (0 on success)
+ */
+uint32_t corpus_generate(const corpus_spec_t* spec, uint32_t seed, uint32_t count, unsigned threads,
+    corpus_ship_t* records);
+
+/**
+ * Write generated layouts to a corpus file.
+ *
+ * @param  path    File to write
+ * @param  spec    Board and fleet the layouts were generated for
+ * @param  seed    Base seed used
+ * @param  count   Number of layouts
+ * @param  records Layout records
+ * @return         Whether the file was written
+ */
+bool corpus_write(const char* path, const corpus_spec_t* spec, uint32_t seed, uint32_t count,
+    const corpus_ship_t* records);
+
+/**
+ * Memory-map a corpus file read-only and validate its header, including that it was
+ * written with this host's byte order.
+ *
+ * @param  path   File to map
+ * @param  corpus Corpus to fill
+ * @return        Whether the file was mapped
+ */
+bool corpus_map(const char* path, corpus_t* corpus);
+
+/**
+ * Unmap a corpus mapped with corpus_map.
+ *
+ * @param corpus Corpus to unmap
+ */
+void corpus_unmap(corpus_t* corpus);
+
+/**
+ * Get the ship placements of a layout in a mapped corpus.
+ *
+ * @param  corpus Mapped corpus
+ * @param  idx    Layout index, less than the header count
+ * @return        Pointer to ship_count placements
+ */
+const corpus_ship_t* corpus_layout(const corpus_t* corpus, uint32_t idx);
+
+/**
+ * Expand a stored placement into a ship's positioning fields.
+ *
+ * @param entry Stored placement
+ * @param ship  Ship to update
+ */
+void corpus_unpack_ship(const corpus_ship_t* entry, ship_t* ship);
+
+#endif // CORPUS_H
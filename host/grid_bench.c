@@ -0,0 +1,107 @@
+/*
+ * Benchmark of the grid data plane in the storage format it is built with (see
+ * GRID_STORAGE in grid.h). The host Makefile builds it as the board is built, with the
+ * grid size fixed at compile time, once per format.
+ *
+ * Usage: grid_bench
+ *
+ * Prints the size of the board's data plane, bitboards and grid_t, which hold no
+ * pointers so match the board build, then the average time per position of the data
+ * accessors: get_grid_data and set_grid_data by coordinate, and row and column walks
+ * with the plane iterators.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "grid.h"
+
+/* Positions accessed per timing, whatever the board size */
+#define BENCH_ACCESSES (20000000UL)
+
+typedef enum {
+    BenchGet,
+    BenchSet,
+    BenchRowWalk,
+    BenchColWalk,
+} bench_op_t;
+
+static const char* const bench_names[] = {"get_grid_data", "set_grid_data", "row iterator", "column iterator"};
+
+/* Keeps reads from being optimised away */
+static volatile uint32_t sink;
+
+double time_accesses(grid_t* grid, bench_op_t op);
+
+
+int main(void) {
+    grid_t grid = {.width = GRID_FIXED_WIDTH, .height = GRID_FIXED_HEIGHT};
+    if (!allocate_grid_data(&grid, true)) {
+        perror("grid");
+        return 1;
+    }
+
+    printf("%s storage, %dx%d board\n", GRID_STORAGE == GRID_STORAGE_NIBBLES ? "nibble" : "byte",
+        grid.width, grid.height);
+    printf("  data plane      %6u bytes\n", get_grid_data_size(grid.width, grid.height));
+    printf("  bitboard_t      %6zu bytes\n", sizeof(bitboard_t));
+    printf("  grid_t          %6zu bytes\n", sizeof(grid_t));
+    for (bench_op_t op = BenchGet; op <= BenchColWalk; op++) {
+        printf("  %-15s %6.2f ns/position\n", bench_names[op], time_accesses(&grid, op));
+    }
+    free_grid_data(&grid);
+    return 0;
+}
+
+/**
+ * Time one accessor over every position of a grid, repeated for BENCH_ACCESSES positions.
+ *
+ * @param  grid Grid to access
+ * @param  op   Accessor to time
+ * @return      Average nanoseconds per position
+ */
+double time_accesses(grid_t* grid, bench_op_t op) {
+    uint16_t positions = grid->width * grid->height;
+    unsigned long passes = BENCH_ACCESSES / positions;
+    uint32_t total = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (unsigned long pass = 0; pass < passes; pass++) {
+        switch (op) {
+        case BenchGet:
+            for (int8_t y = 0; y < grid->height; y++) {
+                for (int8_t x = 0; x < grid->width; x++) {
+                    total += get_grid_data(grid, x, y);
+                }
+            }
+            break;
+        case BenchSet:
+            for (int8_t y = 0; y < grid->height; y++) {
+                for (int8_t x = 0; x < grid->width; x++) {
+                    set_grid_data(grid, x, y, (x + y + pass) & 0x07);
+                }
+            }
+            break;
+        case BenchRowWalk:
+            for (int8_t y = 0; y < grid->height; y++) {
+                grid_iter_t iter = grid_row_iter(grid, y);
+                for (int8_t x = 0; x < grid->width; x++) {
+                    total += grid_iter_next(&iter);
+                }
+            }
+            break;
+        case BenchColWalk:
+            for (int8_t x = 0; x < grid->width; x++) {
+                grid_iter_t iter = grid_col_iter(grid, x);
+                for (int8_t y = 0; y < grid->height; y++) {
+                    total += grid_iter_next(&iter);
+                }
+            }
+            break;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    sink = total;
+    double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    return ns / ((double) passes * positions);
+}
@@ -0,0 +1,184 @@
+/*
+ * Generate a corpus of ship layouts for benchmarking (see corpus.h).
+ *
+ * Usage: layoutgen [options] <output>
+ *   -w <width>     Board width (default 10)
+ *   -h <height>    Board height (default 10)
+ *   -f <lengths>   Comma separated fleet ship lengths (default 2,3,3,4,5)
+ *   -n <count>     Number of layouts (default 100000)
+ *   -s <seed>      Base seed (default 1)
+ *   -t <threads>   Worker threads (default one per CPU)
+ *   -r             Use randomised backtracking rather than uniform sampling
+ *   -a             Forbid ships from touching (records the rule in the corpus header)
+ *
+ *        layoutgen -i <corpus>
+ *   Map an existing corpus, check every layout and print a summary.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "corpus.h"
+
+bool parse_fleet(const char* arg, corpus_spec_t* spec);
+int inspect_corpus(const char* path);
+
+
+int main(int argc, char* argv[]) {
+    corpus_spec_t spec = {.width = 10, .height = 10, .mode = LayoutUniform,
+        .rule = RuleMayTouch};
+    parse_fleet("2,3,3,4,5", &spec);
+    uint32_t count = 100000;
+    uint32_t seed = 1;
+    unsigned threads = 0;
+    const char* inspect = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "w:h:f:n:s:t:rai:")) != -1) {
+        switch (opt) {
+        case 'w':
+            spec.width = atoi(optarg);
+            break;
+        case 'h':
+            spec.height = atoi(optarg);
+            break;
+        case 'f':
+            if (!parse_fleet(optarg, &spec)) {
+                fprintf(stderr, "invalid fleet '%s'\n", optarg);
+                return 2;
+            }
+            break;
+        case 'n':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            threads = atoi(optarg);
+            break;
+        case 'r':
+            spec.mode = LayoutRandom;
+            break;
+        case 'a':
+            spec.rule = RuleNoTouch;
+            break;
+        case 'i':
+            inspect = optarg;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-w width] [-h height] [-f lengths] [-n count] "
+                "[-s seed] [-t threads] [-r] [-a] <output>\n       %s -i <corpus>\n", argv[0], argv[0]);
+            return 2;
+        }
+    }
+    if (inspect) {
+        return inspect_corpus(inspect);
+    }
+    if (optind >= argc) {
+        fprintf(stderr, "missing output file\n");
+        return 2;
+    }
+    if (spec.width < 1 || spec.width > BB_MAX_WIDTH || spec.height < 1 || spec.height > BB_MAX_HEIGHT) {
+        fprintf(stderr, "board must be between 1x1 and %dx%d\n", BB_MAX_WIDTH, BB_MAX_HEIGHT);
+        return 2;
+    }
+
+    corpus_ship_t* records = malloc((size_t) count * spec.ship_count * sizeof(corpus_ship_t));
+    if (records == NULL) {
+        perror("malloc");
+        return 1;
+    }
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint32_t failures = corpus_generate(&spec, seed, count, threads, records);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    if (failures > 0) {
+        fprintf(stderr, "%u of %u layouts could not be placed\n", failures, count);
+        free(records);
+        return 1;
+    }
+    if (!corpus_write(argv[optind], &spec, seed, count, records)) {
+        perror(argv[optind]);
+        free(records);
+        return 1;
+    }
+    fprintf(stderr, "%u layouts in %.3fs (%.0f/s)\n", count, elapsed, count / elapsed);
+    free(records);
+    return 0;
+}
+
+/**
+ * Parse a comma separated list of ship lengths into a spec.
+ *
+ * @param  arg  List to parse
+ * @param  spec Spec to update
+ * @return      Whether the list was valid
+ */
+bool parse_fleet(const char* arg, corpus_spec_t* spec) {
+    uint8_t count = 0;
+    const char* pos = arg;
+    while (*pos) {
+        char* end;
+        long length = strtol(pos, &end, 10);
+        if (end == pos || length < 1 || length > BB_MAX_WIDTH || count == CORPUS_MAX_SHIPS) {
+            return false;
+        }
+        spec->lengths[count++] = length;
+        pos = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            return false;
+        }
+    }
+    spec->ship_count = count;
+    return count > 0;
+}
+
+/**
+ * Map a corpus, replay every layout onto a grid to check it and print a summary.
+ *
+ * @param  path Corpus file
+ * @return      Exit status
+ */
+int inspect_corpus(const char* path) {
+    corpus_t corpus;
+    if (!corpus_map(path, &corpus)) {
+        fprintf(stderr, "%s: not a valid corpus\n", path);
+        return 1;
+    }
+    const corpus_header_t* header = corpus.header;
+    grid_t grid = {.width = header->width, .height = header->height};
+    if (!allocate_grid_data(&grid, false)) {
+        corpus_unmap(&corpus);
+        return 1;
+    }
+    placement_rule = header->rule;
+
+    uint32_t invalid = 0;
+    for (uint32_t idx = 0; idx < header->count; idx++) {
+        const corpus_ship_t* layout = corpus_layout(&corpus, idx);
+        zero_grid_data(&grid);
+        for (uint8_t s = 0; s < header->ship_count; s++) {
+            ship_t ship = {.length = header->lengths[s], SHIP_DEFAULTS};
+            corpus_unpack_ship(&layout[s], &ship);
+            // Ship coordinates only hold on grid positions so check the stored ones first
+            bool on_grid = layout[s].x < header->width && (layout[s].y_dir & CORPUS_Y_MASK) < header->height;
+            if (!on_grid || !place_ship(&grid, &ship, get_ship_ref(s), true)) {
+                invalid++;
+                break;
+            }
+        }
+    }
+    printf("%s: %ux%u board, %u ships, %u layouts (seed %u, %s%s), %u invalid\n", path,
+        header->width, header->height, header->ship_count, header->count, header->seed,
+        header->mode == LayoutUniform ? "uniform" : "random",
+        header->rule == RuleNoTouch ? ", no touching" : "", invalid);
+    free_grid_data(&grid);
+    corpus_unmap(&corpus);
+    return invalid ? 1 : 0;
+}
@@ -0,0 +1,267 @@
+/*
+ * Loopback test for the serial AI link (see link_proto.h). Plays the board side of
+ * the protocol, as ai_link.c does, against ai_daemon over a pseudo-terminal pair.
+ *
+ * Usage: link_test [ai_daemon]
+ *
+ * Checks that every request of a whole game under each placement rule is answered with
+ * a valid shot within AI_LINK_TIMEOUT_MS, that the daemon applies RuleNoTouch, and that
+ * corrupt or malformed requests get no reply so the board falls back to
+ * make_weighted_shot once the deadline has passed.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/wait.h>
+
+#include "grid.h"
+#include "ship.h"
+#include "player.h"
+#include "ai.h"
+#include "ai_link.h"
+#include "arena.h"
+#include "rng.h"
+#include "link_proto.h"
+
+static const ship_def_t test_fleet[] = {
+    {ShipCarrier, 5}, {ShipBattleship, 4}, {ShipCruiser, 3}, {ShipSubmarine, 3}, {ShipDestroyer, 2}
+};
+#define TEST_FLEET_SIZE (sizeof(test_fleet) / sizeof(test_fleet[0]))
+
+static unsigned failures = 0;
+
+int open_pty_pair(int* slave, char* path, size_t size);
+pid_t start_daemon(const char* daemon, const char* path);
+bool await_reply(int fd, int8_t* x, int8_t* y, long* waited_ms);
+uint8_t play_link_game(int fd, arena_t* arena, placement_rule_t rule, player_t* target);
+bool make_link_shot(int fd, player_t* target, bool* fell_back);
+long elapsed_ms(struct timespec* since);
+void check(bool ok, const char* what);
+
+
+int main(int argc, char* argv[]) {
+    const char* daemon = argc > 1 ? argv[1] : "_build/ai_daemon";
+    char path[64];
+    int slave;
+    int fd = open_pty_pair(&slave, path, sizeof(path));
+    if (fd < 0) {
+        perror("pty");
+        return 1;
+    }
+    pid_t pid = start_daemon(daemon, path);
+    if (pid < 0) {
+        perror(daemon);
+        return 1;
+    }
+
+    // A whole game under each rule, every shot must come from the daemon
+    static uint8_t arena_buf[2048] __attribute__((aligned(8)));
+    arena_t arena;
+    arena_init(&arena, arena_buf, sizeof(arena_buf));
+    player_t target;
+    rng_seed(&game_rng, 1);
+    printf("game: %u shots\n", play_link_game(fd, &arena, RuleMayTouch, &target));
+    printf("no touching game: %u shots\n", play_link_game(fd, &arena, RuleNoTouch, &target));
+    placement_rule = RuleMayTouch;
+
+    // A corrupt frame is dropped by the daemon so the deadline runs out
+    uint8_t frame[LINK_FRAME_SIZE(LINK_MAX_PAYLOAD)];
+    uint16_t length = link_encode_request(frame, target.grid, target.ships, target.ship_count);
+    frame[length - 1] ^= 0xFF;
+    check(write(fd, frame, length) == (ssize_t) length, "corrupt request sent");
+    int8_t x, y;
+    long waited;
+    check(!await_reply(fd, &x, &y, &waited), "no reply to a corrupt request");
+    check(waited >= AI_LINK_TIMEOUT_MS, "waited out the deadline");
+    printf("corrupt request: gave up after %ld ms\n", waited);
+
+    // So is a valid frame holding a malformed request, after which the board falls back
+    uint8_t short_payload[LINK_FRAME_SIZE(2)] = {LINK_SOF, LinkShotRequest, 2, 10, 10};
+    short_payload[LINK_HEADER_SIZE + 2] = link_checksum(LinkShotRequest, &short_payload[LINK_HEADER_SIZE], 2);
+    check(write(fd, short_payload, sizeof(short_payload)) == (ssize_t) sizeof(short_payload),
+        "malformed request sent");
+    check(!await_reply(fd, &x, &y, &waited), "no reply to a malformed request");
+    arena_reset(&arena);
+    check(make_player(&target, &arena, 10, 10, test_fleet, TEST_FLEET_SIZE), "player allocated");
+    check(auto_place_ships(target.grid, target.ships, target.ship_count), "ships placed");
+    check(make_weighted_shot(&target), "fallback shot made");
+
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+    close(slave);
+    close(fd);
+    printf("%s\n", failures ? "FAILED" : "passed");
+    return failures ? 1 : 0;
+}
+
+/**
+ * Open a pseudo-terminal pair in raw mode. The slave is held open so the daemon
+ * opening it by path sees the same settings.
+ *
+ * @param  slave Return pointer for the slave file descriptor
+ * @param  path  Buffer for the slave device path
+ * @param  size  Size of the path buffer
+ * @return       Master file descriptor, negative on failure
+ */
+int open_pty_pair(int* slave, char* path, size_t size) {
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+        return -1;
+    }
+    snprintf(path, size, "%s", ptsname(fd));
+    *slave = open(path, O_RDWR | O_NOCTTY);
+    if (*slave < 0) {
+        return -1;
+    }
+    struct termios tio;
+    if (tcgetattr(*slave, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(*slave, TCSANOW, &tio);
+    }
+    return fd;
+}
+
+/**
+ * Run ai_daemon on a device.
+ *
+ * @param  daemon Path of the daemon
+ * @param  path   Device for it to serve
+ * @return        Process id, negative on failure
+ */
+pid_t start_daemon(const char* daemon, const char* path) {
+    if (access(daemon, X_OK) != 0) {
+        return -1;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(daemon, daemon, path, "1", (char*) NULL);
+        _exit(127);
+    }
+    return pid;
+}
+
+/**
+ * Wait for a shot reply, with one deadline of AI_LINK_TIMEOUT_MS for the whole reply
+ * as on the board.
+ *
+ * @param  fd        Link to read from
+ * @param  x         Return pointer for the x coordinate
+ * @param  y         Return pointer for the y coordinate
+ * @param  waited_ms Return pointer for the time spent waiting
+ * @return           Whether a shot reply arrived before the deadline
+ */
+bool await_reply(int fd, int8_t* x, int8_t* y, long* waited_ms) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    link_parser_t parser;
+    link_parser_reset(&parser);
+    bool replied = false;
+    while (!replied && (*waited_ms = elapsed_ms(&start)) < AI_LINK_TIMEOUT_MS) {
+        struct pollfd pfd = {.fd = fd, .events = POLLIN};
+        if (poll(&pfd, 1, AI_LINK_TIMEOUT_MS - *waited_ms) <= 0) {
+            continue;
+        }
+        uint8_t byte;
+        if (read(fd, &byte, 1) == 1 && link_parse_byte(&parser, byte) &&
+            parser.type == LinkShotReply && parser.length == 2) {
+            *x = parser.payload[0];
+            *y = parser.payload[1];
+            replied = true;
+        }
+    }
+    *waited_ms = elapsed_ms(&start);
+    return replied;
+}
+
+/**
+ * Play a whole game against the daemon under a placement rule. Under RuleNoTouch no shot
+ * may be next to a destroyed ship, as the daemon should know no ship can be there.
+ *
+ * @param  fd     Link to the daemon
+ * @param  arena  Arena to allocate the target from, reset first
+ * @param  rule   Placement rule to play under
+ * @param  target Player to allocate and target
+ * @return        Number of shots taken
+ */
+uint8_t play_link_game(int fd, arena_t* arena, placement_rule_t rule, player_t* target) {
+    placement_rule = rule;
+    arena_reset(arena);
+    check(make_player(target, arena, 10, 10, test_fleet, TEST_FLEET_SIZE), "player allocated");
+    check(auto_place_ships(target->grid, target->ships, target->ship_count), "ships placed");
+    uint8_t shots = 0;
+    bool fell_back = false;
+    bool beside_destroyed = false;
+    while (!is_player_destroyed(target) && shots < 100 && !fell_back) {
+        bitboard_t halo;
+        bb_dilate(&target->grid->destroyed, target->grid->width, target->grid->height, &halo);
+        check(make_link_shot(fd, target, &fell_back), "shot made");
+        beside_destroyed |= bb_test(&halo, target->last_x, target->last_y);
+        shots++;
+    }
+    check(!fell_back, "every request answered by the daemon");
+    check(is_player_destroyed(target), "game finished by the daemon");
+    if (rule == RuleNoTouch) {
+        check(!beside_destroyed, "no shots next to destroyed ships without touching");
+    }
+    return shots;
+}
+
+/**
+ * Take a shot the way make_remote_shot does: send the board, use the reply if it is a
+ * valid shot and otherwise fall back to the local AI.
+ *
+ * @param  fd        Link to the daemon
+ * @param  target    Player to target with shot
+ * @param  fell_back Return pointer set if the local AI was used
+ * @return           Whether a shot could be made
+ */
+bool make_link_shot(int fd, player_t* target, bool* fell_back) {
+    uint8_t frame[LINK_FRAME_SIZE(LINK_MAX_PAYLOAD)];
+    uint16_t length = link_encode_request(frame, target->grid, target->ships, target->ship_count);
+    int8_t x, y;
+    long waited;
+    if (length > 0 && write(fd, frame, length) == (ssize_t) length && await_reply(fd, &x, &y, &waited) &&
+        shoot_pos(target, x, y) != Invalid) {
+        target->last_x = x;
+        target->last_y = y;
+        return true;
+    }
+    *fell_back = true;
+    return make_weighted_shot(target);
+}
+
+/**
+ * Get the time since a point in milliseconds.
+ *
+ * @param  since Monotonic clock reading
+ * @return       Milliseconds elapsed
+ */
+long elapsed_ms(struct timespec* since) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+/**
+ * Record the result of a check, reporting failures.
+ *
+ * @param ok   Whether the check passed
+ * @param what Description of what was checked
+ */
+void check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "FAIL: %s\n", what);
+        failures++;
+    }
+}
@@ -0,0 +1,389 @@
+/*
+ * Round trip and rejection tests for the grid and game encodings (see serialize.h), in
+ * the grid storage format the test is built with. The host Makefile builds one copy per
+ * format.
+ *
+ * Usage: serialize_test
+ *
+ * Checks that the default game, games under each placement rule and games part way
+ * through decode to the state they were encoded from, that grids do likewise, and that
+ * truncated encodings, a wrong version or kind, a wrong size and out of range fields
+ * are rejected without changing the placement rule.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "grid.h"
+#include "ship.h"
+#include "player.h"
+#include "game.h"
+#include "ai.h"
+#include "rng.h"
+#include "serialize.h"
+
+#define TEST_WIDTH  (10)
+#define TEST_HEIGHT (10)
+
+/* Bit offsets into a game encoding of the rule, the first player's last shot and first ship */
+#define GAME_RULE_BIT        (8 + 1 + SERIAL_SHOTS_BITS)
+#define GAME_HAS_LAST_BIT    (GAME_RULE_BIT + 2)
+#define GAME_LAST_X_BIT      (GAME_HAS_LAST_BIT + 1)
+#define GAME_SHIP_LENGTH_BIT (GAME_LAST_X_BIT + 4 * SERIAL_COORD_BITS + SERIAL_COUNT_BITS)
+#define GAME_SHIP_X_BIT      (GAME_SHIP_LENGTH_BIT + SERIAL_COORD_BITS + 1)
+/* Bit offsets into a grid encoding of the reference width and the first reference */
+#define GRID_REF_BITS_BIT (18)
+#define GRID_FIRST_REF_BIT (22)
+
+/**
+ * Structure holding everything a game decodes to, for comparing games.
+ */
+typedef struct {
+    uint8_t game[SERIAL_GAME_SIZE(TEST_WIDTH, TEST_HEIGHT, GAME_MAX_SHIPS)];
+    uint16_t game_length;
+    uint8_t grids[2][SERIAL_GRID_SIZE(TEST_WIDTH, TEST_HEIGHT)];
+    uint16_t grid_lengths[2];
+    ship_t ships[2][GAME_MAX_SHIPS];
+    int8_t last[2][2];
+    bool cpu[2];
+    uint8_t turn;
+    uint16_t shots;
+    placement_rule_t rule;
+} snapshot_t;
+
+static unsigned failures = 0;
+
+void test_game_round_trips(void);
+void test_grid_round_trip(void);
+void test_game_rejections(void);
+void test_grid_rejections(void);
+void make_test_game(game_t* game, placement_rule_t rule, uint16_t shots);
+void take_snapshot(game_t* game, snapshot_t* snapshot);
+bool same_snapshot(snapshot_t* a, snapshot_t* b);
+bool round_trip_game(game_t* game);
+void make_test_grid(grid_t* grid, uint8_t width, uint8_t height);
+void set_bits(uint8_t* buf, uint16_t bit, uint16_t value, uint8_t count);
+void check(bool ok, const char* what);
+
+
+int main(void) {
+    printf("%s storage\n", GRID_STORAGE == GRID_STORAGE_NIBBLES ? "nibble" : "byte");
+    test_game_round_trips();
+    test_grid_round_trip();
+    test_game_rejections();
+    test_grid_rejections();
+    printf("%s\n", failures ? "FAILED" : "passed");
+    return failures ? 1 : 0;
+}
+
+/**
+ * Round trip the default game before ships are placed, then games under each placement
+ * rule at the start, part way through and once a player has lost.
+ */
+void test_game_round_trips(void) {
+    game_t game;
+    make_default_game(&game);
+    check(round_trip_game(&game), "default game round trips");
+
+    rng_seed(&game_rng, 3);
+    for (placement_rule_t rule = RuleMayTouch; rule <= RuleNoTouch; rule++) {
+        make_test_game(&game, rule, 0);
+        check(round_trip_game(&game), "placed game round trips");
+        make_test_game(&game, rule, 40);
+        check(round_trip_game(&game), "game part way through round trips");
+
+        // Shots hit and destroy ships, which must come back from the shots alone
+        uint8_t destroyed = 0;
+        for (uint8_t idx = 0; idx < game.player_one->ship_count; idx++) {
+            destroyed += is_ship_destroyed(&game.player_one->ships[idx]);
+        }
+        check(destroyed > 0, "game part way through has destroyed ships");
+
+        make_test_game(&game, rule, 200);
+        check(is_player_destroyed(game.player_one) || is_player_destroyed(game.player_two),
+            "finished game has a loser");
+        check(round_trip_game(&game), "finished game round trips");
+    }
+
+    // Counts past a byte, up to both players shooting all of the largest board
+    game.shots = 2 * GRID_MAX_SIZE * GRID_MAX_SIZE;
+    check(round_trip_game(&game), "largest shot count round trips");
+    placement_rule = RuleMayTouch;
+    free_game(&game);
+}
+
+/**
+ * Round trip a grid holding ships, shots and destroyed positions.
+ */
+void test_grid_round_trip(void) {
+    grid_t grid, decoded;
+    make_test_grid(&grid, TEST_WIDTH, TEST_HEIGHT);
+    decoded = (grid_t) {.width = TEST_WIDTH, .height = TEST_HEIGHT};
+    check(allocate_grid_data(&decoded, true), "grid allocated");
+
+    uint8_t buf[SERIAL_GRID_SIZE(TEST_WIDTH, TEST_HEIGHT)];
+    uint16_t length = serialize_grid(buf, sizeof(buf), &grid);
+    check(length > 0, "grid encoded");
+    check(deserialize_grid(buf, length, &decoded), "grid decoded");
+    bool same = true;
+    for (int8_t y = 0; y < TEST_HEIGHT; y++) {
+        for (int8_t x = 0; x < TEST_WIDTH; x++) {
+            same &= get_grid_data(&grid, x, y) == get_grid_data(&decoded, x, y);
+        }
+    }
+    check(same, "grid positions round trip");
+    check(memcmp(&grid.occupied, &decoded.occupied, sizeof(bitboard_t)) == 0 &&
+        memcmp(&grid.halo, &decoded.halo, sizeof(bitboard_t)) == 0, "grid ship planes round trip");
+    free_grid_data(&grid);
+    free_grid_data(&decoded);
+}
+
+/**
+ * Check that corrupt game encodings are rejected and leave the placement rule alone.
+ */
+void test_game_rejections(void) {
+    game_t game;
+    uint8_t buf[SERIAL_GAME_SIZE(TEST_WIDTH, TEST_HEIGHT, GAME_MAX_SHIPS)];
+    uint8_t bad[sizeof(buf)];
+    make_test_game(&game, RuleNoTouch, 20);
+    uint16_t length = serialize_game(buf, sizeof(buf), &game);
+    check(length > 0, "game encoded");
+    check(serialize_game(buf, length - 1, &game) == 0, "game not encoded into a short buffer");
+
+    placement_rule = RuleMayTouch;
+    bool rejected = true;
+    for (uint16_t truncated = 0; truncated < length; truncated++) {
+        rejected &= !deserialize_game(buf, truncated, &game);
+    }
+    check(rejected, "truncated games rejected");
+
+    memcpy(bad, buf, length);
+    bad[0] = (bad[0] & 0xF0) | (SERIAL_VERSION + 1);
+    check(!deserialize_game(bad, length, &game), "game of another version rejected");
+    memcpy(bad, buf, length);
+    bad[0] = (bad[0] & 0x0F) | (SERIAL_KIND_GRID << 4);
+    check(!deserialize_game(bad, length, &game), "grid encoding rejected as a game");
+    memcpy(bad, buf, length);
+    set_bits(bad, GAME_SHIP_X_BIT, TEST_WIDTH + 1, SERIAL_COORD_BITS);
+    check(!deserialize_game(bad, length, &game), "ship off the grid rejected");
+    memcpy(bad, buf, length);
+    set_bits(bad, GAME_HAS_LAST_BIT, 1, 1);
+    set_bits(bad, GAME_LAST_X_BIT, TEST_WIDTH, SERIAL_COORD_BITS);
+    check(!deserialize_game(bad, length, &game), "last shot off the grid rejected");
+    memcpy(bad, buf, length);
+    set_bits(bad, GAME_SHIP_LENGTH_BIT, 1, SERIAL_COORD_BITS);
+    check(!deserialize_game(bad, length, &game), "ship length not in the fleet rejected");
+    check(placement_rule == RuleMayTouch, "placement rule kept after rejections");
+
+    // Ships that touch are only valid under RuleMayTouch
+    make_default_game(&game);
+    ship_t* ships = game.player_one->ships;
+    ships[0].x = 0, ships[0].y = 0, ships[0].dir = D_East;
+    ships[1].x = 0, ships[1].y = 1, ships[1].dir = D_East;
+    check(place_ship(game.player_one->grid, &ships[0], get_ship_ref(0), true) &&
+        place_ship(game.player_one->grid, &ships[1], get_ship_ref(1), true), "touching ships placed");
+    length = serialize_game(buf, sizeof(buf), &game);
+    set_bits(buf, GAME_RULE_BIT, 1, 1);
+    check(!deserialize_game(buf, length, &game), "touching ships rejected without touching");
+    check(placement_rule == RuleMayTouch, "placement rule kept after touching ships");
+
+    // The wrong game size is rejected
+    make_test_game(&game, RuleMayTouch, 0);
+    length = serialize_game(buf, sizeof(buf), &game);
+    game.player_two->grid->height--;
+    check(!deserialize_game(buf, length, &game), "game of another size rejected");
+    free_game(&game);
+}
+
+/**
+ * Check that corrupt grid encodings are rejected.
+ */
+void test_grid_rejections(void) {
+    grid_t grid, other;
+    make_test_grid(&grid, TEST_WIDTH, TEST_HEIGHT);
+    uint8_t buf[SERIAL_GRID_SIZE(TEST_WIDTH, TEST_HEIGHT)];
+    uint8_t bad[sizeof(buf)];
+    uint16_t length = serialize_grid(buf, sizeof(buf), &grid);
+    check(serialize_grid(buf, length - 1, &grid) == 0, "grid not encoded into a short buffer");
+
+    bool rejected = true;
+    for (uint16_t truncated = 0; truncated < length; truncated++) {
+        rejected &= !deserialize_grid(buf, truncated, &grid);
+    }
+    check(rejected, "truncated grids rejected");
+
+    memcpy(bad, buf, length);
+    bad[0] = (bad[0] & 0xF0) | (SERIAL_VERSION + 1);
+    check(!deserialize_grid(bad, length, &grid), "grid of another version rejected");
+    memcpy(bad, buf, length);
+    bad[0] = (bad[0] & 0x0F) | (SERIAL_KIND_GAME << 4);
+    check(!deserialize_grid(bad, length, &grid), "game encoding rejected as a grid");
+
+    // References wider than a byte, or larger than the data plane holds, are out of range
+    memcpy(bad, buf, length);
+    set_bits(bad, GRID_REF_BITS_BIT, 9, SERIAL_REF_BITS);
+    check(!deserialize_grid(bad, length, &grid), "reference width over 8 bits rejected");
+    if (MAX_POS_DATA < 0xFF) {
+        memcpy(bad, buf, length);
+        set_bits(bad, GRID_REF_BITS_BIT, 8, SERIAL_REF_BITS);
+        set_bits(bad, GRID_FIRST_REF_BIT, MAX_POS_DATA + 1, 8);
+        check(!deserialize_grid(bad, length, &grid), "reference over MAX_POS_DATA rejected");
+    }
+
+    other = (grid_t) {.width = TEST_WIDTH, .height = TEST_HEIGHT - 1};
+    check(allocate_grid_data(&other, true), "grid allocated");
+    check(!deserialize_grid(buf, length, &other), "grid of another size rejected");
+    free_grid_data(&other);
+    free_grid_data(&grid);
+}
+
+/**
+ * Make a default game with both fleets placed under a rule, then play shots alternately
+ * with the weighted AI until a player has lost or the shots run out.
+ *
+ * @param game  Game to make
+ * @param rule  Placement rule to place under, left as the placement rule
+ * @param shots Number of shots to take
+ */
+void make_test_game(game_t* game, placement_rule_t rule, uint16_t shots) {
+    make_default_game(game);
+    placement_rule = rule;
+    game->player_two->cpu = true;
+    check(auto_place_ships(game->player_one->grid, game->player_one->ships, game->player_one->ship_count) &&
+        auto_place_ships(game->player_two->grid, game->player_two->ships, game->player_two->ship_count),
+        "ships placed");
+    while (game->shots < shots && !is_player_destroyed(game->player_one) &&
+        !is_player_destroyed(game->player_two)) {
+        make_weighted_shot(get_next_player(game));
+        game->turn = next_player_idx(game);
+        game->shots++;
+    }
+}
+
+/**
+ * Record the decoded state of a game, with its encodings.
+ *
+ * @param game     Game to record
+ * @param snapshot Snapshot to fill
+ */
+void take_snapshot(game_t* game, snapshot_t* snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->game_length = serialize_game(snapshot->game, sizeof(snapshot->game), game);
+    for (uint8_t idx = 0; idx < 2; idx++) {
+        player_t* player = idx ? game->player_two : game->player_one;
+        snapshot->grid_lengths[idx] = serialize_grid(snapshot->grids[idx], sizeof(snapshot->grids[idx]),
+            player->grid);
+        memcpy(snapshot->ships[idx], player->ships, player->ship_count * sizeof(ship_t));
+        snapshot->last[idx][0] = player->last_x;
+        snapshot->last[idx][1] = player->last_y;
+        snapshot->cpu[idx] = player->cpu;
+    }
+    snapshot->turn = game->turn;
+    snapshot->shots = game->shots;
+    snapshot->rule = placement_rule;
+}
+
+/**
+ * Compare two snapshots, ships by their fields.
+ *
+ * @param  a First snapshot
+ * @param  b Second snapshot
+ * @return   Whether they hold the same state
+ */
+bool same_snapshot(snapshot_t* a, snapshot_t* b) {
+    for (uint8_t idx = 0; idx < 2; idx++) {
+        for (uint8_t s = 0; s < GAME_MAX_SHIPS; s++) {
+            ship_t* sa = &a->ships[idx][s];
+            ship_t* sb = &b->ships[idx][s];
+            if (sa->length != sb->length || sa->hits != sb->hits || sa->placed != sb->placed ||
+                (sa->placed && (sa->x != sb->x || sa->y != sb->y || sa->dir != sb->dir))) {
+                return false;
+            }
+        }
+        if (a->grid_lengths[idx] == 0 || a->grid_lengths[idx] != b->grid_lengths[idx] ||
+            memcmp(a->grids[idx], b->grids[idx], a->grid_lengths[idx]) != 0 ||
+            memcmp(a->last[idx], b->last[idx], sizeof(a->last[idx])) != 0 || a->cpu[idx] != b->cpu[idx]) {
+            return false;
+        }
+    }
+    return a->game_length > 0 && a->game_length == b->game_length &&
+        memcmp(a->game, b->game, a->game_length) == 0 &&
+        a->turn == b->turn && a->shots == b->shots && a->rule == b->rule;
+}
+
+/**
+ * Encode a game and decode it into a fresh default game under the other placement rule.
+ *
+ * @param  game Game to round trip, replaced by the decoded game
+ * @return      Whether the decoded game matches the original
+ */
+bool round_trip_game(game_t* game) {
+    static snapshot_t before, after;
+    take_snapshot(game, &before);
+    make_default_game(game);
+    placement_rule = before.rule == RuleNoTouch ? RuleMayTouch : RuleNoTouch;
+    if (!deserialize_game(before.game, before.game_length, game)) {
+        return false;
+    }
+    take_snapshot(game, &after);
+    return same_snapshot(&before, &after);
+}
+
+/**
+ * Make a grid holding the default fleet with some shots and a destroyed ship.
+ *
+ * @param grid   Grid to make
+ * @param width  Width of the grid
+ * @param height Height of the grid
+ */
+void make_test_grid(grid_t* grid, uint8_t width, uint8_t height) {
+    game_t game;
+    make_test_game(&game, RuleMayTouch, 60);
+    *grid = (grid_t) {.width = width, .height = height};
+    check(allocate_grid_data(grid, true), "grid allocated");
+    uint8_t shot = 0, destroyed = 0;
+    for (int8_t y = 0; y < height; y++) {
+        for (int8_t x = 0; x < width; x++) {
+            g_data data = get_grid_data(game.player_one->grid, x, y);
+            set_grid_data(grid, x, y, data);
+            shot += (data & SHOT_POS) != 0;
+            destroyed += (data & DESTROY_POS) != 0;
+        }
+    }
+    bb_dilate(&grid->occupied, width, height, &grid->halo);
+    check(shot > 0 && destroyed > 0, "test grid has shots and destroyed positions");
+    free_game(&game);
+}
+
+/**
+ * Overwrite bits of an encoding, least significant bit first as the encoder writes them.
+ *
+ * @param buf   Encoding to update
+ * @param bit   Offset of the first bit
+ * @param value Value to write
+ * @param count Number of bits to write
+ */
+void set_bits(uint8_t* buf, uint16_t bit, uint16_t value, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++, bit++) {
+        if (value & (1 << i)) {
+            buf[bit >> 3] |= 1 << (bit & 7);
+        } else {
+            buf[bit >> 3] &= ~(1 << (bit & 7));
+        }
+    }
+}
+
+/**
+ * Record the result of a check, reporting failures.
+ *
+ * @param ok   Whether the check passed
+ * @param what Description of what was checked
+ */
+void check(bool ok, const char* what) {
+    if (!ok) {
+        fprintf(stderr, "FAIL: %s\n", what);
+        failures++;
+    }
+}
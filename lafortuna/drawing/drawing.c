@@ -78,17 +78,7 @@ void stroke_line_straight(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, ui
   write_data16(y2);
   write_cmd(MEMORY_WRITE);
 
-  uint16_t h,w,i,j;
-  h = y2-y1;
-  w = x2-x1;
-
-  for(i = 0; i<=h; i++)
-  {
-    for(j = 0; j<=w; j++)
-    {
-      write_data16(col);
-    }
-  }
+  write_pixels(col, (uint32_t) (y2-y1+1) * (x2-x1+1));
 }
 
 void stroke_line_low(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t col)
@@ -105,20 +95,26 @@ void stroke_line_low(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_
   }
   D = 2*dy - dx;
 
-  uint16_t x, y;
+  /* Pixels are sent a row at a time, run is where the current row started */
+  uint16_t x, y, run;
   y = y1;
+  run = x1;
   for(x = x1; x<=x2; x++)
   {
-    draw_pixel(x, y, col);
-
     if(D > 0)
     {
+      stroke_line_straight(run, y, x, y, col);
+      run = x+1;
       y += yi;
       D -= 2*dx;
     }
 
     D += 2*dy;
   }
+  if(run <= x2)
+  {
+    stroke_line_straight(run, y, x2, y, col);
+  }
 }
 
 void stroke_line_high(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t col)
@@ -135,20 +131,26 @@ void stroke_line_high(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16
   }
   D = 2*dx - dy;
 
-  uint16_t x, y;
+  /* Pixels are sent a column at a time, run is where the current column started */
+  uint16_t x, y, run;
   x = x1;
+  run = y1;
   for(y = y1; y<=y2; y++)
   {
-    draw_pixel(x, y, col);
-
     if(D > 0)
     {
+      stroke_line_straight(x, run, x, y, col);
+      run = y+1;
       x += xi;
       D -= 2*dy;
     }
 
     D += 2*dx;
   }
+  if(run <= y2)
+  {
+    stroke_line_straight(x, run, x, y2, col);
+  }
 }
 
 void stroke_rectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t col)
@@ -156,6 +158,18 @@ void stroke_rectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t c
   stroke_filled_rectangle(x, y, w, h, col, display.background);
 }
 
+void outline_rectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t col)
+{
+  /* Only the border is sent, the interior is left as it is */
+  stroke_line_straight(x, y, x+w, y, col);
+  stroke_line_straight(x, y+h, x+w, y+h, col);
+  if(h > 1)
+  {
+    stroke_line_straight(x, y+1, x, y+h-1, col);
+    stroke_line_straight(x+w, y+1, x+w, y+h-1, col);
+  }
+}
+
 void stroke_filled_rectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t col, uint16_t col2) 
 {
   write_cmd(COLUMN_ADDRESS_SET);
@@ -166,23 +180,23 @@ void stroke_filled_rectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uin
   write_data16(y+h);
   write_cmd(MEMORY_WRITE);
 
-  uint16_t i,j;
-  for(i = 0; i<=h; i++)
+  /* Too thin to have an interior, it is all border */
+  if(w < 2 || h < 2)
+  {
+    write_pixels(col, (uint32_t) (w+1) * (h+1));
+    return;
+  }
+
+  /* Border rows, then interior rows with a border pixel at each end */
+  write_pixels(col, w+1);
+  uint16_t i;
+  for(i = 1; i<h; i++)
   {
     write_data16(col);
-    for(j = 1; j<=w-1; j++)
-    {
-      if(i == 0 || i == h)
-      {
-        write_data16(col);
-      }
-      else
-      {
-        write_data16(col2);
-      }
-    }
+    write_pixels(col2, w-1);
     write_data16(col);
   }
+  write_pixels(col, w+1);
 }
 
 void stroke_rounded_rectangle(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t r, uint16_t col)
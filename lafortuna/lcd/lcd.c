@@ -115,7 +115,7 @@ void set_frame_rate_hz(uint8_t f)
     /*   !!! FIXME !!!  [KPZ-30.01.2015] */
     /*   Check whether this works for diva > 0  */
     /*   See ILI9341 datasheet, page 155  */
-    period = 1920.0/f;
+    period = 1920/f;
     rtna = period >> diva;
     write_cmd(FRAME_CONTROL_IN_NORMAL_MODE);
     write_data(diva);
@@ -138,24 +138,19 @@ void fill_rectangle(rectangle r, uint16_t col)
 */
     uint16_t wpixels = r.right - r.left + 1;
     uint16_t hpixels = r.bottom - r.top + 1;
-    uint8_t mod8, div8;
-    uint16_t odm8, odd8;
-    if (hpixels > wpixels) {
-        mod8 = hpixels & 0x07;
-        div8 = hpixels >> 3;
-        odm8 = wpixels*mod8;
-        odd8 = wpixels*div8;
-    } else {
-        mod8 = wpixels & 0x07;
-        div8 = wpixels >> 3;
-        odm8 = hpixels*mod8;
-        odd8 = hpixels*div8;
-    }
-    uint8_t pix1 = odm8 & 0x07;
+    write_pixels(col, (uint32_t) wpixels * hpixels);
+}
+
+/*  Stream count pixels of one colour into the current window, eight
+    at a time once the odd pixels are out of the way.
+*/
+void write_pixels(uint16_t col, uint32_t count)
+{
+    uint8_t pix1 = count & 0x07;
     while(pix1--)
         write_data16(col);
 
-    uint16_t pix8 = odd8 + (odm8 >> 3);
+    uint16_t pix8 = count >> 3;
     while(pix8--) {
         write_data16(col);
         write_data16(col);
@@ -193,10 +188,11 @@ void clear_screen()
 
 void display_char(char c)
 {
-    uint16_t x, y;
+    uint16_t x;
     PGM_P fdata; 
-    uint8_t bits, mask;
-    uint16_t sc=display.x, ec=display.x + 4, sp=display.y, ep=display.y + 7;
+    uint8_t bits[6], mask;
+    uint16_t fg=display.foreground, bg=display.background;
+    uint16_t sc=display.x, ec=display.x + 5, sp=display.y, ep=display.y + 7;
 
     /*   New line starts a new line, or if the end of the
          display has been reached, clears the display.
@@ -208,25 +204,25 @@ void display_char(char c)
     }
 
     if (c < 32 || c > 126) return;
+    /*   Read the glyph before sending anything, the sixth
+         column is the gap to the next character.
+    */
     fdata = (c - ' ')*5 + font5x7;
+    for(x=0; x<5; x++)
+        bits[x] = pgm_read_byte(fdata++);
+    bits[5] = 0;
+
+    /*   One window for the whole glyph, filled a row at a time. */
+    write_cmd(COLUMN_ADDRESS_SET);
+    write_data16(sc);
+    write_data16(ec);
     write_cmd(PAGE_ADDRESS_SET);
     write_data16(sp);
     write_data16(ep);
-    for(x=sc; x<=ec; x++) {
-        write_cmd(COLUMN_ADDRESS_SET);
-        write_data16(x);
-        write_data16(x);
-        write_cmd(MEMORY_WRITE);
-        bits = pgm_read_byte(fdata++);
-        for(y=sp, mask=0x01; y<=ep; y++, mask<<=1)
-            write_data16((bits & mask) ? display.foreground : display.background);
-    }
-    write_cmd(COLUMN_ADDRESS_SET);
-    write_data16(x);
-    write_data16(x);
     write_cmd(MEMORY_WRITE);
-    for(y=sp; y<=ep; y++)
-        write_data16(display.background);
+    for(mask=0x01; mask; mask<<=1)
+        for(x=0; x<6; x++)
+            write_data16((bits[x] & mask) ? fg : bg);
 
     display.x += 6;
     if (display.x >= display.width) { display.x=0; display.y+=8; }
@@ -249,6 +245,21 @@ void display_string_xy(char *str, uint16_t x, uint16_t y)
         display_char(str[i]);
 }
 
+void display_string_P(PGM_P str)
+{
+    char c;
+    while ((c = pgm_read_byte(str++)))
+        display_char(c);
+}
+
+void display_string_xy_P(PGM_P str, uint16_t x, uint16_t y)
+{
+    display.x = x;
+    display.y = y;
+    start_x = display.x;
+    display_string_P(str);
+}
+
 void display_register(uint8_t reg)
 {
 	uint8_t i;
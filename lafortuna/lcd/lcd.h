@@ -7,6 +7,7 @@
 #define LCD_H
 
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 #include <stdint.h>
 #include "printf.h"
 
@@ -46,9 +47,12 @@ void set_frame_rate_hz(uint8_t f);
 void clear_screen();
 void fill_rectangle(rectangle r, uint16_t col);
 void fill_rectangle_indexed(rectangle r, uint16_t* col);
+void write_pixels(uint16_t col, uint32_t count);
 void display_char(char c);
 void display_string(char *str);
 void display_string_xy(char *str, uint16_t x, uint16_t y);
+void display_string_P(PGM_P str);
+void display_string_xy_P(PGM_P str, uint16_t x, uint16_t y);
 void display_register(uint8_t reg);
 
 #endif
\ No newline at end of file
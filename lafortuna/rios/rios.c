@@ -12,7 +12,6 @@
 #include <stdint.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
-#include <math.h>
 #include <util/delay.h>
 #include "rios.h"
 
@@ -72,6 +71,10 @@ ISR(TIMER0_OVF_vect) {
 
 #ifdef OS_LED_BRIGHTNESS
 
+/* Timer 0 overflows every 256 * 64 cycles: 125/256 ticks per ms at 8 MHz */
+#define TICKS_PER_MS_NUM (F_CPU / 64000UL)
+#define TICKS_PER_MS_DEN (256UL)
+
 /* Use PWM mode to also control LED brightness from Timer 0 */
 void os_init_scheduler() {
 
@@ -84,7 +87,7 @@ void os_init_scheduler() {
             | _BV(CS01);   /* F_CPU/64, DS p.112 */
 
 
-    /* Interrupts at 488.3 Hz: FCPU/(510*N) with N=64, DS p.105 */  
+    /* Interrupts at 488.3 Hz: FCPU/(256*N) with N=64, DS p.105 */  
 
     TIMSK0 = _BV(TOIE0); /* enable overflow interrupt for T0, DS p.113  */
     TCNT0 = 0;
@@ -136,7 +139,9 @@ int os_add_task(int (*fnc)(int), uint32_t period_ms, int initState) {
    } else {
 
    #ifdef  OS_LED_BRIGHTNESS
-	  tasks[t].period_ms = 488.3/1000.0 * period_ms + 0.5;
+	  /* Convert to ticks, rounded, without overflowing or using floats */
+	  tasks[t].period_ms = (period_ms / TICKS_PER_MS_DEN) * TICKS_PER_MS_NUM
+	      + ((period_ms % TICKS_PER_MS_DEN) * TICKS_PER_MS_NUM + TICKS_PER_MS_DEN / 2) / TICKS_PER_MS_DEN;
    #else
 	  tasks[t].period_ms = period_ms;
    #endif	/* OS_LED_BRIGHTNESS */
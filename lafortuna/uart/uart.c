@@ -0,0 +1,65 @@
+/* FortunaOS: Serial Link
+
+   Polled USART1 driver, see uart.h.
+
+*/
+
+#include <avr/io.h>
+#include <util/delay.h>
+#include "uart.h"
+
+/* Double speed mode: UBRR = F_CPU/(8*BAUD) - 1, DS p.190 */
+#define UART_UBRR ((F_CPU + 4UL * UART_BAUD) / (8UL * UART_BAUD) - 1)
+
+/* Polling interval whilst waiting for a byte */
+#define UART_POLL_US 50
+#define UART_POLLS_PER_MS (1000 / UART_POLL_US)
+/* Time taken by one 10 bit 8N1 character on the line, in polls */
+#define UART_POLLS_PER_BYTE ((10000000UL / UART_BAUD + UART_POLL_US - 1) / UART_POLL_US)
+
+
+void os_init_uart(void) {
+    UBRR1 = UART_UBRR;
+    UCSR1A = _BV(U2X1);
+    UCSR1B = _BV(RXEN1) | _BV(TXEN1);
+    UCSR1C = _BV(UCSZ11) | _BV(UCSZ10);   /* 8N1 */
+}
+
+
+void uart_putc(uint8_t c) {
+    loop_until_bit_is_set(UCSR1A, UDRE1);
+    UDR1 = c;
+}
+
+
+void uart_write(const uint8_t *buf, uint16_t len) {
+    while (len--)
+        uart_putc(*buf++);
+}
+
+
+void uart_start_deadline(uart_deadline_t *deadline, uint16_t timeout_ms) {
+    *deadline = (uint32_t) timeout_ms * UART_POLLS_PER_MS;
+}
+
+
+bool uart_getc_deadline(uint8_t *c, uart_deadline_t *deadline) {
+    while (*deadline) {
+        if (bit_is_set(UCSR1A, RXC1)) {
+            *c = UDR1;
+            /* A received byte still used up the time it took to arrive */
+            *deadline = *deadline > UART_POLLS_PER_BYTE ? *deadline - UART_POLLS_PER_BYTE : 0;
+            return true;
+        }
+        _delay_us(UART_POLL_US);
+        (*deadline)--;
+    }
+    return false;
+}
+
+
+bool uart_getc_timeout(uint8_t *c, uint16_t timeout_ms) {
+    uart_deadline_t deadline;
+    uart_start_deadline(&deadline, timeout_ms);
+    return uart_getc_deadline(c, &deadline);
+}
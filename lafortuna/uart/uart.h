@@ -0,0 +1,34 @@
+/* FortunaOS: Serial Link
+
+   Polled driver for USART1 (PD2 RXD1, PD3 TXD1), used to talk to a host
+   over the board's serial link. Runs at UART_BAUD with double speed mode,
+   8 data bits, no parity and 1 stop bit.
+
+*/
+
+#ifndef UART_H
+#define UART_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UART_BAUD 38400UL
+
+void os_init_uart(void);
+
+void uart_putc(uint8_t c);
+void uart_write(const uint8_t *buf, uint16_t len);
+
+/* Time left for a run of reads, counted in receiver polls: */
+typedef uint32_t uart_deadline_t;
+
+/* Start a deadline timeout_ms from now, shared by the reads that follow: */
+void uart_start_deadline(uart_deadline_t *deadline, uint16_t timeout_ms);
+
+/* Returns true if a byte was received before the deadline passed: */
+bool uart_getc_deadline(uint8_t *c, uart_deadline_t *deadline);
+
+/* Returns true if a byte was received before timeout_ms elapsed: */
+bool uart_getc_timeout(uint8_t *c, uint16_t timeout_ms);
+
+#endif /* UART_H */
@@ -0,0 +1,383 @@
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "layout.h"
+
+/**
+ * Structure holding the state of a backtracking layout search. A single set of availability
+ * masks is shared by every level of the search to keep stack use independent of fleet size.
+ */
+typedef struct {
+    bitboard_t* occupied;
+    avail_masks_t* avail;
+    ship_t* ships;
+    uint8_t count;
+    uint8_t width;
+    uint8_t height;
+    uint16_t free_cells;
+    uint16_t required_cells;
+    uint16_t budget;
+    uint8_t last_length;
+    uint16_t last_key;
+    rng_t* rng;
+} layout_search_t;
+
+/* Function Prototypes */
+bool sample_uniform_layout(bitboard_t* base, uint8_t width, uint8_t height, ship_t ships[], uint8_t count,
+    rng_t* rng);
+uint8_t find_length_slot(uint8_t lengths[], uint8_t count, uint8_t length);
+bool backtrack_layout(layout_search_t* search);
+bool backtrack_exact_layout(layout_search_t* search);
+bool try_placement(layout_search_t* search, ship_t* ship);
+uint16_t gen_canonical_availability(layout_search_t* search, uint8_t length);
+uint16_t get_placement_key(ship_t* ship);
+uint16_t count_coverable_cells(layout_search_t* search);
+bitboard_t* get_search_blocked(layout_search_t* search, bitboard_t* scratch);
+
+
+layout_res_t sample_layout(grid_t* grid, ship_t ships[], uint8_t count, layout_mode_t mode, rng_t* rng) {
+    bitboard_t occupied = grid->occupied;
+    layout_res_t res = LayoutPlaced;
+
+    bool placed = false;
+    if (mode == LayoutUniform) {
+        placed = sample_uniform_layout(get_blocked_bitboard(grid), grid->width, grid->height, ships, count, rng);
+        if (!placed) {
+            res = LayoutFallback;
+        }
+    }
+
+    if (!placed) {
+        avail_masks_t avail;
+        layout_search_t search = {
+            .occupied = &occupied, .avail = &avail, .ships = ships, .count = count,
+            .width = grid->width, .height = grid->height, .required_cells = 0,
+            .budget = LAYOUT_MAX_BACKTRACKS, .last_length = 0, .rng = rng
+        };
+        search.free_cells = grid->width * grid->height;
+        for (uint8_t row = 0; row < grid->height; row++) {
+            search.free_cells -= bb_row_popcount(occupied.rows[row]);
+        }
+        for (uint8_t idx = 0; idx < count; idx++) {
+            ships[idx].placed = false;
+            search.required_cells += ships[idx].length;
+        }
+        placed = backtrack_layout(&search);
+        if (!placed) {
+            return search.budget == 0 ? LayoutGaveUp : LayoutUnsatisfiable;
+        }
+    }
+
+    // Commit the complete layout
+    for (uint8_t idx = 0; idx < count; idx++) {
+        place_ship(grid, &ships[idx], get_ship_ref(idx), false);
+    }
+    return res;
+}
+
+
+bool is_layout_placed(layout_res_t res) {
+    return res == LayoutPlaced || res == LayoutFallback;
+}
+
+/**
+ * Attempt to draw a complete layout by rejection sampling. Every ship is drawn uniformly from the
+ * placements that fit the base, the draw is accepted only if no drawn ships overlap (or touch, under
+ * RuleNoTouch).
+ *
+ * @param  base   Positions blocked by ships already on the grid
+ * @param  width  Width of the grid
+ * @param  height Height of the grid
+ * @param  ships  Ships to draw positions for
+ * @param  count  Number of ships
+ * @param  rng    Random stream to draw from
+ * @return        Whether a draw was accepted within LAYOUT_MAX_REJECTS attempts
+ */
+bool sample_uniform_layout(bitboard_t* base, uint8_t width, uint8_t height, ship_t ships[], uint8_t count,
+    rng_t* rng) {
+    // Placements only depend on the base and the ship length, so they are generated once per length
+    // and kept for later draws. Any lengths beyond LAYOUT_MAX_LENGTHS take turns in the last slot.
+    avail_masks_t avail[LAYOUT_MAX_LENGTHS];
+    uint8_t lengths[LAYOUT_MAX_LENGTHS];
+    uint8_t cached = 0;
+    for (uint16_t attempt = 0; attempt < LAYOUT_MAX_REJECTS; attempt++) {
+        bitboard_t blocked = *base;
+        bool accepted = true;
+        for (uint8_t idx = 0; idx < count && accepted; idx++) {
+            ship_t* ship = &ships[idx];
+            uint8_t slot = find_length_slot(lengths, cached, ship->length);
+            if (slot == cached) {
+                if (cached < LAYOUT_MAX_LENGTHS) {
+                    cached++;
+                } else {
+                    slot = LAYOUT_MAX_LENGTHS - 1;
+                }
+                lengths[slot] = ship->length;
+                if (gen_availability_masks(base, width, height, ship->length, &avail[slot]) == 0) {
+                    return false;
+                }
+            }
+            allocate_ship_pos(&avail[slot], ship, 1 + rng_uniform(rng, avail[slot].count));
+            accepted = !ship_overlaps_bitboard(&blocked, ship);
+            block_ship_on_bitboard(&blocked, ship, width, height);
+        }
+        if (accepted) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Find the slot of a ship length among the lengths whose placements have been generated.
+ *
+ * @param  lengths Lengths in slot order
+ * @param  count   Number of lengths
+ * @param  length  Length to look for
+ * @return         Slot of the length, count if it is not present
+ */
+uint8_t find_length_slot(uint8_t lengths[], uint8_t count, uint8_t length) {
+    uint8_t slot = 0;
+    while (slot < count && lengths[slot] != length) {
+        slot++;
+    }
+    return slot;
+}
+
+/**
+ * Place the longest unplaced ship at each level of a depth first search, trying its placements
+ * from a random starting point. Placements covering the same positions (e.g. North and South from
+ * opposite ends) are only tried once, and ships of equal length are only tried in increasing position
+ * order as swapping them gives the same layout. Ships are marked placed on the occupancy bitboard only.
+ *
+ * @param  search Search state
+ * @return        Whether all remaining ships could be placed
+ */
+bool backtrack_layout(layout_search_t* search) {
+    // Pick the longest ship still to place
+    ship_t* ship = NULL;
+    for (uint8_t idx = 0; idx < search->count; idx++) {
+        if (!search->ships[idx].placed && (ship == NULL || search->ships[idx].length > ship->length)) {
+            ship = &search->ships[idx];
+        }
+    }
+    if (ship == NULL) {
+        return true;
+    }
+    // Prune if the remaining ships cannot fit in the remaining space
+    if (search->required_cells > search->free_cells ||
+        search->required_cells > count_coverable_cells(search)) {
+        return false;
+    }
+    // With no spare positions every position must be covered, so search by position instead
+    if (search->required_cells == search->free_cells) {
+        return backtrack_exact_layout(search);
+    }
+
+    uint8_t prev_length = search->last_length;
+    uint16_t prev_key = search->last_key;
+    bool ordered = ship->length == prev_length;
+
+    uint16_t available = gen_canonical_availability(search, ship->length);
+    uint16_t start = available > 0 ? rng_uniform(search->rng, available) : 0;
+    bool regenerate = false;
+    for (uint16_t i = 0; i < available; i++) {
+        if (search->budget == 0) {
+            break;
+        }
+        // Deeper levels share the masks so regenerate them after a failed attempt
+        if (regenerate) {
+            gen_canonical_availability(search, ship->length);
+            regenerate = false;
+        }
+        allocate_ship_pos(search->avail, ship, 1 + (start + i) % available);
+        uint16_t key = get_placement_key(ship);
+        if (ordered && key <= prev_key) {
+            continue;
+        }
+        search->last_length = ship->length;
+        search->last_key = key;
+        if (try_placement(search, ship)) {
+            return true;
+        }
+        regenerate = true;
+    }
+    search->last_length = prev_length;
+    search->last_key = prev_key;
+    return false;
+}
+
+/**
+ * Fill the remaining space exactly. The first empty position (in row order) must be the top left of
+ * some remaining ship, so each distinct remaining length is tried there facing East and South.
+ *
+ * @param  search Search state, with required_cells equal to free_cells
+ * @return        Whether all remaining ships could be placed
+ */
+bool backtrack_exact_layout(layout_search_t* search) {
+    // Find the first empty position
+    bb_row_t row_mask = bb_row_mask(search->width);
+    uint8_t y = 0;
+    while (y < search->height && !(~search->occupied->rows[y] & row_mask)) {
+        y++;
+    }
+    if (y == search->height) {
+        return false;
+    }
+    uint8_t x = bb_row_select(~search->occupied->rows[y] & row_mask, 1);
+    bitboard_t scratch;
+    bitboard_t* blocked = get_search_blocked(search, &scratch);
+
+    // Options are (ship, direction) pairs, tried from a random starting point
+    uint8_t options = search->count * 2;
+    uint8_t start = rng_uniform(search->rng, options);
+    for (uint8_t i = 0; i < options; i++) {
+        uint8_t option = (start + i) % options;
+        ship_t* ship = &search->ships[option / 2];
+        if (ship->placed) {
+            continue;
+        }
+        // Only the first unplaced ship of each length is tried, equal ships are interchangeable
+        bool repeat = false;
+        for (uint8_t prev = 0; prev < option / 2 && !repeat; prev++) {
+            repeat = !search->ships[prev].placed && search->ships[prev].length == ship->length;
+        }
+        ship->x = x;
+        ship->y = y;
+        ship->dir = option % 2 ? D_South : D_East;
+        if (repeat || (ship->dir == D_South && ship->length == 1)) {
+            continue;
+        }
+        if ((ship->dir == D_East && x + ship->length > search->width) ||
+            (ship->dir == D_South && y + ship->length > search->height) ||
+            ship_overlaps_bitboard(blocked, ship)) {
+            continue;
+        }
+        if (search->budget == 0) {
+            break;
+        }
+        if (try_placement(search, ship)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Place a ship on the search occupancy and continue the search, undoing the placement
+ * if the search fails.
+ *
+ * @param  search Search state
+ * @param  ship   Ship with a valid position set
+ * @return        Whether all remaining ships could be placed
+ */
+bool try_placement(layout_search_t* search, ship_t* ship) {
+    search->budget--;
+    add_ship_to_bitboard(search->occupied, ship);
+    ship->placed = true;
+    search->free_cells -= ship->length;
+    search->required_cells -= ship->length;
+    if (backtrack_layout(search)) {
+        return true;
+    }
+    remove_ship_from_bitboard(search->occupied, ship);
+    ship->placed = false;
+    search->free_cells += ship->length;
+    search->required_cells += ship->length;
+    return false;
+}
+
+/**
+ * Generate availability masks for the search, keeping only one of each pair of placements
+ * that cover the same positions (East and South, or just East for single position ships).
+ *
+ * @param  search Search state
+ * @param  length Ship length
+ * @return        Number of distinct placements
+ */
+uint16_t gen_canonical_availability(layout_search_t* search, uint8_t length) {
+    avail_masks_t* avail = search->avail;
+    bitboard_t scratch;
+    gen_availability_masks(get_search_blocked(search, &scratch), search->width, search->height, length, avail);
+    for (dir_t dir = D_North; dir <= D_West; dir++) {
+        if (dir == D_East || (dir == D_South && length > 1)) {
+            continue;
+        }
+        for (uint8_t row = 0; row < avail->height; row++) {
+            avail->count -= avail->row_count[dir][row];
+            avail->row_count[dir][row] = 0;
+            avail->dir[dir].rows[row] = 0;
+        }
+    }
+    return avail->count;
+}
+
+/**
+ * Get a key that orders canonical placements by position, used to avoid trying ships of equal
+ * length in every order.
+ *
+ * @param  ship Ship with a canonical (East or South) placement
+ * @return      Placement key
+ */
+uint16_t get_placement_key(ship_t* ship) {
+    return ((ship->y * BB_MAX_WIDTH + ship->x) << 1) | (ship->dir == D_South);
+}
+
+/**
+ * Count the empty positions that could still be covered by some placement of an unplaced ship.
+ * Pockets too small for any remaining ship are excluded, which prunes dense searches early.
+ * The search availability masks are used as scratch.
+ *
+ * @param  search Search state
+ * @return        Number of coverable positions
+ */
+uint16_t count_coverable_cells(layout_search_t* search) {
+    bitboard_t coverable;
+    bb_clear(&coverable);
+    avail_masks_t* avail = search->avail;
+
+    for (uint8_t idx = 0; idx < search->count; idx++) {
+        ship_t* ship = &search->ships[idx];
+        bool repeat = ship->placed;
+        for (uint8_t prev = 0; prev < idx && !repeat; prev++) {
+            repeat = !search->ships[prev].placed && search->ships[prev].length == ship->length;
+        }
+        if (repeat) {
+            continue;
+        }
+        // Spread each available origin over the positions its ship would cover
+        gen_canonical_availability(search, ship->length);
+        for (uint8_t row = 0; row < search->height; row++) {
+            bb_row_t east = avail->dir[D_East].rows[row];
+            bb_row_t south = avail->dir[D_South].rows[row];
+            for (uint8_t i = 0; i < ship->length; i++) {
+                coverable.rows[row] |= east << i;
+                if (row + i < search->height) {
+                    coverable.rows[row + i] |= south;
+                }
+            }
+        }
+    }
+
+    uint16_t count = 0;
+    for (uint8_t row = 0; row < search->height; row++) {
+        count += bb_row_popcount(coverable.rows[row]);
+    }
+    return count;
+}
+
+/**
+ * Get the positions that the next ship placed by the search may not cover. Without RuleNoTouch
+ * this is the search occupancy itself, otherwise the blocked positions are generated into scratch.
+ *
+ * @param  search  Search state
+ * @param  scratch Bitboard that may be used to hold the result
+ * @return         Blocked positions
+ */
+bitboard_t* get_search_blocked(layout_search_t* search, bitboard_t* scratch) {
+    if (placement_rule != RuleNoTouch) {
+        return search->occupied;
+    }
+    gen_blocked_bitboard(search->occupied, search->width, search->height, scratch);
+    return scratch;
+}
@@ -0,0 +1,68 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "grid.h"
+#include "ship.h"
+#include "bitboard.h"
+#include "rng.h"
+
+/* Number of whole-fleet draws attempted by uniform sampling before backtracking is used */
+#define LAYOUT_MAX_REJECTS    (250)
+/* Ship lengths whose placements uniform sampling keeps between draws, the default fleet has four */
+#ifndef LAYOUT_MAX_LENGTHS
+#define LAYOUT_MAX_LENGTHS    (4)
+#endif
+/* Number of trial placements the backtracking search may make before giving up */
+#ifndef LAYOUT_MAX_BACKTRACKS
+#define LAYOUT_MAX_BACKTRACKS (20000)
+#endif
+
+/**
+ * Enumeration of layout sampling modes.
+ */
+typedef enum {
+    LayoutRandom,  // Randomised backtracking search, fast but not uniform
+    LayoutUniform, // Every complete layout is equally likely
+} layout_mode_t;
+
+/**
+ * Enumeration of layout sampling results.
+ */
+typedef enum {
+    LayoutPlaced,        // All ships placed as requested
+    LayoutFallback,      // All ships placed, but uniform sampling gave up so backtracking was used
+    LayoutUnsatisfiable, // No complete layout exists, no ships were placed
+    LayoutGaveUp,        // The search budget ran out, no ships were placed
+} layout_res_t;
+
+/**
+ * Using a grid that may be filled with ships as a basis, place the full list of ships randomly.
+ * Unlike placing ships one at a time, a complete layout is always found if one exists (within
+ * LAYOUT_MAX_BACKTRACKS trial placements). Ships are either all placed or none are.
+ *
+ * In LayoutUniform mode, each ship is drawn independently from every placement that fits the
+ * starting grid and the whole draw is rejected if any ships overlap. Accepted layouts are therefore
+ * uniform over all complete layouts. If LAYOUT_MAX_REJECTS draws are rejected (only likely for
+ * dense fleets), backtracking is used instead and LayoutFallback is returned.
+ *
+ * @param  grid  Currently placed ships (no shot bits allowed to be set)
+ * @param  ships Ships to place, positioning fields are overwritten
+ * @param  count Number of ships in provided list
+ * @param  mode  Sampling mode
+ * @param  rng   Random stream to draw from
+ * @return       Result of sampling, ships are only placed for LayoutPlaced and LayoutFallback
+ */
+layout_res_t sample_layout(grid_t* grid, ship_t ships[], uint8_t count, layout_mode_t mode, rng_t* rng);
+
+/**
+ * Check whether a layout result indicates that the ships were placed.
+ *
+ * @param  res Result of sample_layout
+ * @return     Whether the ships were placed
+ */
+bool is_layout_placed(layout_res_t res);
+
+#endif // LAYOUT_H
@@ -0,0 +1,202 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "link_proto.h"
+
+/* Parser states */
+#define PARSE_SOF      (0)
+#define PARSE_TYPE     (1)
+#define PARSE_LENGTH   (2)
+#define PARSE_PAYLOAD  (3)
+#define PARSE_CHECKSUM (4)
+#define PARSE_DONE     (5)
+
+uint16_t link_finish_frame(uint8_t* buf, link_msg_t type, uint8_t length);
+uint8_t crc8_update(uint8_t crc, uint8_t byte);
+
+
+uint8_t link_checksum(uint8_t type, const uint8_t* payload, uint8_t length) {
+    uint8_t crc = crc8_update(0, type);
+    crc = crc8_update(crc, length);
+    for (uint8_t i = 0; i < length; i++) {
+        crc = crc8_update(crc, payload[i]);
+    }
+    return crc;
+}
+
+
+uint16_t link_encode_request(uint8_t* buf, grid_t* grid, ship_t ships[], uint8_t ship_count) {
+    uint16_t cells = grid->width * grid->height;
+    if (ship_count > LINK_MAX_SHIPS || cells > LINK_MAX_CELLS) {
+        return 0;
+    }
+    uint8_t* payload = &buf[LINK_HEADER_SIZE];
+    uint8_t length = 0;
+
+    payload[length++] = grid->width;
+    payload[length++] = grid->height;
+    payload[length++] = ship_count | (placement_rule == RuleNoTouch ? LINK_RULE_NO_TOUCH : 0);
+    for (uint8_t idx = 0; idx < ship_count; idx++) {
+        payload[length++] = (ships[idx].length & LINK_SHIP_LENGTH) |
+            (is_ship_destroyed(&ships[idx]) ? LINK_SHIP_DESTROYED : 0);
+    }
+
+    // Pack cells four to a byte, row by row
+    uint16_t cell = 0;
+    memset(&payload[length], 0, (cells + 3) / 4);
+    for (int8_t y = 0; y < grid->height; y++) {
+        grid_iter_t iter = grid_row_iter(grid, y);
+        for (int8_t x = 0; x < grid->width; x++, cell++) {
+            uint8_t data = grid_iter_next(&iter);
+            uint8_t state = LINK_CELL_UNKNOWN;
+            if (bb_test(&grid->destroyed, x, y)) {
+                state = LINK_CELL_DESTROYED;
+            } else if (bb_test(&grid->shot, x, y)) {
+                state = data ? LINK_CELL_HIT : LINK_CELL_MISS;
+            }
+            payload[length + cell / 4] |= state << ((cell % 4) * 2);
+        }
+    }
+    length += (cells + 3) / 4;
+
+    return link_finish_frame(buf, LinkShotRequest, length);
+}
+
+
+bool link_decode_request(const uint8_t* payload, uint8_t length, grid_t* grid,
+    ship_t ships[], uint8_t* ship_count, placement_rule_t* rule) {
+    if (length < 3) {
+        return false;
+    }
+    uint8_t width = payload[0];
+    uint8_t height = payload[1];
+    uint8_t count = payload[2] & LINK_SHIP_COUNT;
+    uint16_t cells = width * height;
+    if (count > LINK_MAX_SHIPS || cells > LINK_MAX_CELLS ||
+        length != 3 + count + (cells + 3) / 4) {
+        return false;
+    }
+
+    // Ships are only described by length and whether they are destroyed
+    for (uint8_t idx = 0; idx < count; idx++) {
+        uint8_t entry = payload[3 + idx];
+        ship_t ship = {.length = entry & LINK_SHIP_LENGTH, SHIP_DEFAULTS};
+        ship.hits = entry & LINK_SHIP_DESTROYED ? ship.length : 0;
+        ships[idx] = ship;
+    }
+    *ship_count = count;
+    *rule = payload[2] & LINK_RULE_NO_TOUCH ? RuleNoTouch : RuleMayTouch;
+
+    grid->width = width;
+    grid->height = height;
+    if (!allocate_grid_data(grid, true)) {
+        return false;
+    }
+    const uint8_t* packed = &payload[3 + count];
+    uint16_t cell = 0;
+    for (int8_t y = 0; y < height; y++) {
+        for (int8_t x = 0; x < width; x++, cell++) {
+            uint8_t state = (packed[cell / 4] >> ((cell % 4) * 2)) & 0x03;
+            switch (state) {
+            case LINK_CELL_MISS:
+                set_grid_data(grid, x, y, SHOT_POS);
+                break;
+            case LINK_CELL_HIT:
+                set_grid_data(grid, x, y, SHOT_POS | 1);
+                break;
+            case LINK_CELL_DESTROYED:
+                set_grid_data(grid, x, y, SHOT_POS | DESTROY_POS | 1);
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+
+uint16_t link_encode_reply(uint8_t* buf, int8_t x, int8_t y) {
+    buf[LINK_HEADER_SIZE] = x;
+    buf[LINK_HEADER_SIZE + 1] = y;
+    return link_finish_frame(buf, LinkShotReply, 2);
+}
+
+
+void link_parser_reset(link_parser_t* parser) {
+    parser->state = PARSE_SOF;
+    parser->received = 0;
+}
+
+
+bool link_parse_byte(link_parser_t* parser, uint8_t byte) {
+    switch (parser->state) {
+    case PARSE_DONE:
+        // Previous frame has been consumed
+        link_parser_reset(parser);
+        // fall through
+    case PARSE_SOF:
+        if (byte == LINK_SOF) {
+            parser->state = PARSE_TYPE;
+        }
+        break;
+    case PARSE_TYPE:
+        parser->type = byte;
+        parser->state = PARSE_LENGTH;
+        break;
+    case PARSE_LENGTH:
+        if (byte > LINK_MAX_PAYLOAD) {
+            link_parser_reset(parser);
+            break;
+        }
+        parser->length = byte;
+        parser->received = 0;
+        parser->state = byte ? PARSE_PAYLOAD : PARSE_CHECKSUM;
+        break;
+    case PARSE_PAYLOAD:
+        parser->payload[parser->received++] = byte;
+        if (parser->received == parser->length) {
+            parser->state = PARSE_CHECKSUM;
+        }
+        break;
+    case PARSE_CHECKSUM:
+        if (byte == link_checksum(parser->type, parser->payload, parser->length)) {
+            parser->state = PARSE_DONE;
+            return true;
+        }
+        link_parser_reset(parser);
+        break;
+    }
+    return false;
+}
+
+/**
+ * Write the header and checksum around a payload that has already been placed
+ * in the frame buffer.
+ *
+ * @param  buf    Frame buffer with payload filled
+ * @param  type   Frame type
+ * @param  length Number of payload bytes
+ * @return        Length of the complete frame
+ */
+uint16_t link_finish_frame(uint8_t* buf, link_msg_t type, uint8_t length) {
+    buf[0] = LINK_SOF;
+    buf[1] = type;
+    buf[2] = length;
+    buf[LINK_HEADER_SIZE + length] = link_checksum(type, &buf[LINK_HEADER_SIZE], length);
+    return LINK_FRAME_SIZE(length);
+}
+
+/**
+ * Add a byte to a running CRC-8 (polynomial 0x07). A CRC is used over a plain sum
+ * so that swapped bytes are also detected.
+ *
+ * @param  crc  Current CRC value
+ * @param  byte Byte to add
+ * @return      Updated CRC value
+ */
+uint8_t crc8_update(uint8_t crc, uint8_t byte) {
+    crc ^= byte;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+    return crc;
+}
@@ -0,0 +1,123 @@
+#ifndef LINK_PROTO_H
+#define LINK_PROTO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "grid.h"
+#include "ship.h"
+
+/* Frame layout: {SOF}{TYPE}{LEN}{PAYLOAD...}{CHECKSUM} */
+#define LINK_SOF          (0xB5)
+#define LINK_HEADER_SIZE  (3)
+#define LINK_FRAME_SIZE(len) (LINK_HEADER_SIZE + (len) + 1)
+
+#define LINK_MAX_SHIPS    (8)
+#define LINK_MAX_CELLS    (GRID_MAX_SIZE * GRID_MAX_SIZE)
+#define LINK_MAX_PAYLOAD  (3 + LINK_MAX_SHIPS + LINK_MAX_CELLS / 4)
+
+/* Two bit cell states used in a shot request */
+#define LINK_CELL_UNKNOWN   (0)
+#define LINK_CELL_MISS      (1)
+#define LINK_CELL_HIT       (2)
+#define LINK_CELL_DESTROYED (3)
+
+/* The ship count byte has its top bit set when ships may not touch (RuleNoTouch) */
+#define LINK_RULE_NO_TOUCH  (0x80)
+#define LINK_SHIP_COUNT     (0x7F)
+
+/* Ship entries are a length with the top bit flagging a destroyed ship */
+#define LINK_SHIP_DESTROYED (0x80)
+#define LINK_SHIP_LENGTH    (0x7F)
+
+/**
+ * Enumeration of frame types that can be sent over the link.
+ */
+typedef enum {
+    LinkShotRequest = 0x01, // Board -> Host: target board state
+    LinkShotReply   = 0x02, // Host -> Board: position to shoot
+} link_msg_t;
+
+/**
+ * Structure holding the state of a byte-wise frame parser. A parser should be
+ * cleared with link_parser_reset before first use.
+ */
+typedef struct {
+    uint8_t state;
+    uint8_t type;
+    uint8_t length;
+    uint8_t received;
+    uint8_t checksum;
+    uint8_t payload[LINK_MAX_PAYLOAD];
+} link_parser_t;
+
+/**
+ * Calculate the checksum of a frame. This covers the type, length and payload
+ * bytes but not the start of frame marker.
+ *
+ * @param  type    Frame type
+ * @param  payload Frame payload
+ * @param  length  Number of payload bytes
+ * @return         Frame checksum
+ */
+uint8_t link_checksum(uint8_t type, const uint8_t* payload, uint8_t length);
+
+/**
+ * Encode the known state of a target board as a shot request frame. Only information
+ * an opponent could know is sent; ship positions are never included. The current
+ * placement rule is sent with the ship count so the host AI can apply it.
+ * Payload: {WIDTH}{HEIGHT}{RULE | SHIP COUNT}{SHIPS...}{CELLS (2 bits each, row by row)...}
+ *
+ * @param  buf        Buffer of at least LINK_FRAME_SIZE(LINK_MAX_PAYLOAD) bytes
+ * @param  grid       Grid that is being targeted
+ * @param  ships      Ships on the targeted grid
+ * @param  ship_count Number of ships passed
+ * @return            Length of the encoded frame, 0 if the board cannot be encoded
+ */
+uint16_t link_encode_request(uint8_t* buf, grid_t* grid, ship_t ships[], uint8_t ship_count);
+
+/**
+ * Decode a shot request payload into a grid and ship list. Shot cells are reconstructed with
+ * an arbitrary ship reference so that the usual hit/miss/destroy checks apply.
+ *
+ * @param  payload    Received payload
+ * @param  length     Number of payload bytes
+ * @param  grid       Grid to update, data is allocated to the decoded size (which must match
+ *                    the fixed grid size unless built with GRID_RUNTIME_SIZE)
+ * @param  ships      Ship list to fill, must hold LINK_MAX_SHIPS
+ * @param  ship_count Return pointer for number of ships decoded
+ * @param  rule       Return pointer for the placement rule of the game
+ * @return            Whether the payload was valid
+ */
+bool link_decode_request(const uint8_t* payload, uint8_t length, grid_t* grid,
+    ship_t ships[], uint8_t* ship_count, placement_rule_t* rule);
+
+/**
+ * Encode a shot reply frame.
+ *
+ * @param  buf Buffer of at least LINK_FRAME_SIZE(2) bytes
+ * @param  x   x coordinate to shoot
+ * @param  y   y coordinate to shoot
+ * @return     Length of the encoded frame
+ */
+uint16_t link_encode_reply(uint8_t* buf, int8_t x, int8_t y);
+
+/**
+ * Clear a parser so it waits for the next start of frame.
+ *
+ * @param parser Parser to reset
+ */
+void link_parser_reset(link_parser_t* parser);
+
+/**
+ * Feed a received byte into a parser. Corrupt frames are dropped and the parser
+ * resynchronises on the next start of frame marker.
+ *
+ * @param  parser Parser to update
+ * @param  byte   Received byte
+ * @return        Whether a complete, valid frame is now held in the parser
+ */
+bool link_parse_byte(link_parser_t* parser, uint8_t byte);
+
+#endif // LINK_PROTO_H
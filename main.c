@@ -5,6 +5,8 @@
 
 #include "ui_drawing.h"
 #include "menu.h"
+#include "ai_link.h"
+#include "rng.h"
 
 #include "lafortuna/os.h"
 #include "lafortuna/lcd/lcd.h"
@@ -16,6 +18,9 @@ void update_seed(void);
 int main() {
     os_init();
     update_seed();
+#ifdef AI_LINK
+    init_ai_link();
+#endif
 
     // Load menu
     clear_screen();
@@ -27,11 +32,12 @@ int main() {
 }
 
 /**
- * Load the current seed stored in EEPROM, use it as the current seed. 
+ * Load the current seed stored in EEPROM, use it as the current seed for rand() and the game stream.
  * Increment it and write it back.
  */
 void update_seed(void) {
   uint16_t seed = eeprom_read_word(&stored_seed);
   srand(seed);
+  rng_seed(&game_rng, seed);
   eeprom_write_word(&stored_seed, seed + 1);
 }
@@ -0,0 +1,150 @@
+#ifdef MEM_REPORT
+
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "mem_report.h"
+#include "ui_drawing.h"
+#include "control.h"
+
+#include "lafortuna/os.h"
+#include "lafortuna/uart/uart.h"
+
+/* Space left below the stack pointer when repainting, covers the repainting call itself */
+#define MEM_REPAINT_GUARD (16)
+
+/* Symbols provided by the linker and avr-libc's malloc */
+extern uint8_t __heap_start;
+extern uint8_t* __brkval;
+
+/* Function Prototypes */
+void paint_memory_at_boot(void) __attribute__((naked, used, section(".init3")));
+uint8_t* get_heap_top(void);
+void format_mem_usage(char* buf, PGM_P label, mem_usage_t* usage);
+
+/* Worst use seen for each phase */
+static mem_usage_t phase_usage[MemPhaseCount];
+
+
+/**
+ * Paint all memory after the static data, run before main so nothing is on the stack yet.
+ */
+void paint_memory_at_boot(void) {
+    for (uint8_t* pos = &__heap_start; pos <= (uint8_t*) RAMEND; pos++) {
+        *pos = MEM_CANARY;
+    }
+}
+
+
+void get_mem_usage(mem_usage_t* usage) {
+    uint8_t* start = &__heap_start;
+    uint8_t* end = (uint8_t*) (uintptr_t) SP;
+    // Stack and heap data can hold the canary too, so only the longest run is the gap
+    uint8_t* run_start = end;
+    uint8_t* gap_start = end;
+    uint16_t run = 0;
+    uint16_t gap = 0;
+    for (uint8_t* pos = start; pos < end; pos++) {
+        if (*pos != MEM_CANARY) {
+            run = 0;
+            continue;
+        }
+        if (run++ == 0) {
+            run_start = pos;
+        }
+        if (run > gap) {
+            gap = run;
+            gap_start = run_start;
+        }
+    }
+    usage->heap_peak = gap_start - start;
+    usage->free_gap = gap;
+    usage->stack_peak = (uint8_t*) RAMEND + 1 - (gap_start + gap);
+}
+
+
+void repaint_free_memory(void) {
+    // Interrupts would push below the stack pointer whilst it is painted
+    cli();
+    uint8_t* end = (uint8_t*) (uintptr_t) SP - MEM_REPAINT_GUARD;
+    for (uint8_t* pos = get_heap_top(); pos < end; pos++) {
+        *pos = MEM_CANARY;
+    }
+    sei();
+}
+
+
+void record_mem_phase(mem_phase_t phase) {
+    mem_usage_t usage;
+    get_mem_usage(&usage);
+    mem_usage_t* worst = &phase_usage[phase];
+    bool recorded = worst->stack_peak != 0;
+    if (usage.stack_peak > worst->stack_peak) {
+        worst->stack_peak = usage.stack_peak;
+    }
+    if (usage.heap_peak > worst->heap_peak) {
+        worst->heap_peak = usage.heap_peak;
+    }
+    if (!recorded || usage.free_gap < worst->free_gap) {
+        worst->free_gap = usage.free_gap;
+    }
+}
+
+
+mem_usage_t* get_mem_phase_usage(mem_phase_t phase) {
+    return &phase_usage[phase];
+}
+
+
+void show_mem_report(void) {
+    char buf[192];
+    char* line = buf;
+    strcpy_P(line, PSTR("Phase    Stack Heap  Gap\n"));
+    line += strlen(line);
+    format_mem_usage(line, PSTR("Placement"), &phase_usage[MemPlacement]);
+    line += strlen(line);
+    format_mem_usage(line, PSTR("Shooting "), &phase_usage[MemShooting]);
+    line += strlen(line);
+    format_mem_usage(line, PSTR("Finish   "), &phase_usage[MemFinish]);
+    line += strlen(line);
+    mem_usage_t now;
+    get_mem_usage(&now);
+    format_mem_usage(line, PSTR("Now      "), &now);
+
+    // Send the same table to the host
+    os_init_uart();
+    uart_write((uint8_t*) buf, strlen(buf));
+
+    strcat_P(line, PSTR("\n"));
+    strcat_P(line, str_press_continue);
+    clear_screen();
+    draw_centred_string(buf, &draw_area);
+    wait_for_press(SWC);
+}
+
+
+/**
+ * Get the current top of the heap, the heap start if nothing has been allocated.
+ *
+ * @return Address after the last heap byte
+ */
+uint8_t* get_heap_top(void) {
+    return __brkval != NULL ? __brkval : &__heap_start;
+}
+
+
+/**
+ * Write a line of the memory report table.
+ *
+ * @param buf   Buffer to write to
+ * @param label Row label in program memory, padded to the column width
+ * @param usage Memory use to show
+ */
+void format_mem_usage(char* buf, PGM_P label, mem_usage_t* usage) {
+    strcpy_P(buf, label);
+    buf += strlen(buf);
+    sprintf_P(buf, PSTR("%5u%5u%5u\n"), usage->stack_peak, usage->heap_peak, usage->free_gap);
+}
+
+#endif // MEM_REPORT
@@ -0,0 +1,74 @@
+#ifndef MEM_REPORT_H
+#define MEM_REPORT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Value painted over unused memory, bytes still holding it have never been touched */
+#define MEM_CANARY (0xC5)
+
+/**
+ * Enumeration of game phases that memory use is recorded for.
+ */
+typedef enum {
+    MemPlacement,
+    MemShooting,
+    MemFinish,
+    MemPhaseCount
+} mem_phase_t;
+
+/**
+ * Structure holding peak memory use, all sizes are in bytes.
+ */
+typedef struct {
+    uint16_t stack_peak; // Deepest the stack has reached
+    uint16_t heap_peak;  // Most heap memory in use (from the heap start)
+    uint16_t free_gap;   // Memory never reached by either
+} mem_usage_t;
+
+/* Wrapper macros for phase recording (build with -DMEM_REPORT to enable) */
+#ifdef MEM_REPORT
+#define begin_mem_phase()      (repaint_free_memory())
+#define end_mem_phase(phase)   (record_mem_phase(phase))
+#else
+#define begin_mem_phase()      ((void) 0)
+#define end_mem_phase(phase)   ((void) 0)
+#endif
+
+/**
+ * Get the peak memory use since the free memory was last painted. The untouched region
+ * is found as the longest run of MEM_CANARY between the heap start and the stack.
+ *
+ * @param usage Return pointer for memory use
+ */
+void get_mem_usage(mem_usage_t* usage);
+
+/**
+ * Paint the memory between the heap top and the stack, so the peaks of the following
+ * code can be found.
+ */
+void repaint_free_memory(void);
+
+/**
+ * Record the peak memory use of a phase, kept as the worst seen over every game.
+ *
+ * @param phase Phase that has finished
+ */
+void record_mem_phase(mem_phase_t phase);
+
+/**
+ * Get the worst memory use recorded for a phase.
+ *
+ * @param  phase Phase to get
+ * @return       Pointer to recorded use, all zero if the phase has not been recorded
+ */
+mem_usage_t* get_mem_phase_usage(mem_phase_t phase);
+
+/**
+ * Show the recorded memory use of each phase and the current use on a screen, and send
+ * the same report over the serial link. Returns once 'Centre' is pressed.
+ */
+void show_mem_report(void);
+
+#endif // MEM_REPORT_H
@@ -1,9 +1,10 @@
-#include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "menu.h"
 #include "ui_drawing.h"
 #include "control.h"
+#include "mem_report.h"
 
 #include "lafortuna/os.h"
 #include "lafortuna/lcd/lcd.h"
@@ -21,6 +22,16 @@ void handle_main_menu_selection(main_menu_option_t selection) {
         case BothAIs:
             play_battleships(true, true);
             break;
+        case PlacementRule:
+            placement_rule = placement_rule == RuleNoTouch ? RuleMayTouch : RuleNoTouch;
+            break;
+#ifdef MEM_REPORT
+        case MemoryReport:
+            show_mem_report();
+            break;
+#endif
+        default:
+            break;
     }
 }
 
@@ -33,7 +44,10 @@ void loop_main_menu_input(void) {
         // Handle current selection
         if (get_switch_short(_BV(SWC))) {
             handle_main_menu_selection(cur_selection);
-            cur_selection = 0;
+            // Settings keep their selection so they can be toggled again
+            if (cur_selection != PlacementRule) {
+                cur_selection = 0;
+            }
             draw_main_menu(cur_selection, true);
         }
 
@@ -41,7 +55,7 @@ void loop_main_menu_input(void) {
         int8_t last_selection = cur_selection;
         int8_t delta = os_enc_delta(); 
         if (delta != 0) {
-            if (signbit(delta) != signbit(tracked_delta)) {
+            if ((delta < 0) != (tracked_delta < 0)) {
                 tracked_delta = 0;
             }
             tracked_delta += delta;
@@ -60,9 +74,9 @@ void loop_main_menu_input(void) {
 
         // Update screen for current selection
         if (last_selection != cur_selection) {
-            cur_selection = (cur_selection) % (BothAIs + 1);
+            cur_selection = (cur_selection) % MainMenuItemCount;
             if (cur_selection < 0) {
-                cur_selection = BothAIs - (cur_selection + 1);
+                cur_selection = (MainMenuItemCount - 1) - (cur_selection + 1);
             } 
             draw_main_menu(cur_selection, false);   
         }
@@ -75,7 +89,7 @@ void draw_main_menu(main_menu_option_t selection, bool clear) {
         clear_screen();
     }
 
-    int8_t item_count = BothAIs + 1; // (last enum value)
+    int8_t item_count = MainMenuItemCount;
 
     int16_t button_width = 100;
     int16_t button_height = 30;
@@ -83,7 +97,7 @@ void draw_main_menu(main_menu_option_t selection, bool clear) {
     int16_t height_required = button_height * item_count + button_spacing * (item_count - 1);
 
     for (uint8_t item=0; item < item_count; item++) {
-        char* text;
+        PGM_P text;
 
         rectangle button;
         button.left = (display.width - button_width) / 2;
@@ -93,16 +107,24 @@ void draw_main_menu(main_menu_option_t selection, bool clear) {
         
         switch (item) {
             case OnePlayer:
-                text = "One Player";
+                text = PSTR("One Player");
                 break;
             case TwoPlayerHotseat:
-                text = "Two Player\n (Hotseat)";
+                text = PSTR("Two Player\n (Hotseat)");
                 break;
             case BothAIs:
-                text = "AI vs AI";
+                text = PSTR("AI vs AI");
+                break;
+            case PlacementRule:
+                text = placement_rule == RuleNoTouch ? PSTR("Touching: Off") : PSTR("Touching: On");
+                break;
+#ifdef MEM_REPORT
+            case MemoryReport:
+                text = PSTR("Memory");
                 break;
+#endif
             default:
-                text = "?";
+                text = PSTR("?");
         }
         draw_menu_button(&button, text, selection == item);
     }
@@ -112,11 +134,11 @@ void draw_main_menu(main_menu_option_t selection, bool clear) {
 
     display.background = 0x0000;
     display.foreground = 0xFFFF;
-    draw_centred_string(" BATTLESHIPS\n(David Jones)", &title_rec);
+    draw_centred_string_P(PSTR(" BATTLESHIPS\n(David Jones)"), &title_rec);
 }
 
 
-void draw_menu_button(rectangle* rec, char* text, bool selected) {
+void draw_menu_button(rectangle* rec, PGM_P text, bool selected) {
     // Draw menu button
     stroke_filled_rectangle(
         rec->left,
@@ -131,5 +153,5 @@ void draw_menu_button(rectangle* rec, char* text, bool selected) {
     // Draw menu button text
     display.foreground = MESSAGE_BOX_FG;
     display.background = MESSAGE_BOX_BG;
-    draw_centred_string(text, rec);
+    draw_centred_string_P(text, rec);
 }
@@ -13,6 +13,11 @@ typedef enum {
     OnePlayer,
     TwoPlayerHotseat,
     BothAIs,
+    PlacementRule,
+#ifdef MEM_REPORT
+    MemoryReport,
+#endif
+    MainMenuItemCount
 } main_menu_option_t;
 
 /**
@@ -41,10 +46,10 @@ void draw_main_menu(main_menu_option_t selection, bool clear);
  * Draw a single menu button, with text centred on it.
  * 
  * @param rec      Size/Positioning of button
- * @param text     Text to display on button
+ * @param text     Text to display on button, in program memory
  * @param selected Whether to paint it as selected
  */
-void draw_menu_button(rectangle* rec, char* text, bool selected);
+void draw_menu_button(rectangle* rec, PGM_P text, bool selected);
 
 
 #endif // MENU_H
\ No newline at end of file
@@ -3,41 +3,38 @@
 #include <stdlib.h>
 #include "player.h"
 
-void make_player(player_t* player, uint8_t width, uint8_t height, ship_t ships[], uint8_t ship_count) {
+bool make_player(player_t* player, arena_t* arena, uint8_t width, uint8_t height, const ship_def_t fleet[],
+    uint8_t ship_count) {
     // Create a grid for the player
-    grid_t* player_grid = malloc(sizeof(player_grid));
+    grid_t* player_grid = arena_alloc(arena, sizeof(grid_t));
+    ship_t* player_ships = arena_alloc(arena, ship_count * sizeof(ship_t));
+    if (player_grid == NULL || player_ships == NULL) {
+        return false;
+    }
     player_grid->width = width;
     player_grid->height = height;
+    if (!allocate_arena_grid_data(player_grid, arena, true)) {
+        return false;
+    }
 
-    allocate_grid_data(player_grid, true);
-
-    // Copy the ships for the player
-    ship_t* player_ships = malloc(ship_count * sizeof(ship_t));
+    // Only the ship states are per player, the fleet is shared
     for (uint8_t ship_idx=0; ship_idx < ship_count; ship_idx++) {
-        player_ships[ship_idx] = ships[ship_idx];
+        make_ship(&player_ships[ship_idx], &fleet[ship_idx]);
     }
     // Create player
     player->grid = player_grid;
+    player->fleet = fleet;
     player->ships = player_ships;
     player->ship_count = ship_count;
     player->last_x = BLOCKED_POS;
     player->last_y = BLOCKED_POS;
-}
-
-
-void free_player(player_t* player) {
-    free(player->grid);
-    free(player->grid->data);
-    free(player->ships);
+    return true;
 }
 
 
 bool is_player_destroyed(player_t* player) {
-    bool destroyed = true;
-    for (uint8_t ship_idx = 0; ship_idx < player->ship_count; ship_idx++) {
-        destroyed &= is_ship_destroyed(&player->ships[ship_idx]);
-    }
-    return destroyed;
+    // Destroyed once no ship position is left unshot
+    return count_unshot_positions(player->grid, &player->grid->occupied) == 0;
 }
 
 
@@ -54,7 +51,7 @@ shot_res_t shoot_pos(player_t* target, int8_t x, int8_t y) {
         mark_shot(target->grid, x, y);
         if (data != 0) {
             // Do ship hit behaviour
-            uint8_t idx = data - 1;
+            uint8_t idx = get_ship_idx(data);
             target->ships[idx].hits++;
             ret_code = Hit;
             // Check if ship is also destroyed
@@ -24,29 +24,28 @@ typedef struct {
     grid_t* grid; // Grid with ships placed and enemy shots
     int8_t last_x;
     int8_t last_y;
-    ship_t* ships;
+    const ship_def_t* fleet; // Shared fleet definition in program memory
+    ship_t* ships;           // State of each ship in the fleet
     uint8_t ship_count;
     bool cpu;
 } player_t;
 
 
 /**
- * Generate a new player using a new grid and a copy of the provided ship list.
+ * Generate a new player using a new grid and unplaced ship states for a fleet, all taken
+ * from an arena. The fleet definition is referenced rather than copied so must outlive the
+ * player. The player's memory is released with the arena.
  *
  * @param  player     Pointer to player to update 
+ * @param  arena      Arena to allocate the grid and ships from
  * @param  width      Width of grid to generate
  * @param  height     Height of grid to generate
- * @param  ships      List of ships to copy to player
- * @param  ship_count Number of ships to place
+ * @param  fleet      Fleet definition in program memory
+ * @param  ship_count Number of ships in the fleet
+ * @return            Whether the arena had enough memory for the player
  */
-void make_player(player_t* player, uint8_t width, uint8_t height, ship_t ships[], uint8_t ship_count);
-
-/**
- * Free all memory used by player, this will stop the player being usable.
- *
- * @param player Player for which to free
- */
-void free_player(player_t* player);
+bool make_player(player_t* player, arena_t* arena, uint8_t width, uint8_t height, const ship_def_t fleet[],
+    uint8_t ship_count);
 
 /**
  * Check if all player's ships are destroyed.
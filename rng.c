@@ -0,0 +1,56 @@
+#include "rng.h"
+
+rng_t game_rng = {.state = 1};
+
+uint32_t rng_mix(uint32_t value);
+
+
+void rng_seed(rng_t* rng, uint32_t seed) {
+    rng->state = rng_mix(seed);
+    // The all zero state is a fixed point of xorshift
+    if (rng->state == 0) {
+        rng->state = 1;
+    }
+}
+
+
+void rng_seed_stream(rng_t* rng, uint32_t seed, uint32_t index) {
+    rng_seed(rng, rng_mix(seed) ^ index);
+}
+
+
+uint16_t rng_next(rng_t* rng) {
+    // xorshift32, uses the high bits as they are better distributed
+    uint32_t x = rng->state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng->state = x;
+    return x >> 16;
+}
+
+
+uint16_t rng_uniform(rng_t* rng, uint16_t n) {
+    // Reject the top partial range so every value is equally likely
+    uint16_t limit = UINT16_MAX - UINT16_MAX % n;
+    uint16_t value;
+    do {
+        value = rng_next(rng);
+    } while (value >= limit);
+    return value % n;
+}
+
+/**
+ * Scramble a 32 bit value (murmur3 finaliser) so that similar inputs give unrelated outputs.
+ *
+ * @param  value Value to scramble
+ * @return       Scrambled value
+ */
+uint32_t rng_mix(uint32_t value) {
+    value ^= value >> 16;
+    value *= 0x85EBCA6BUL;
+    value ^= value >> 13;
+    value *= 0xC2B2AE35UL;
+    value ^= value >> 16;
+    return value;
+}
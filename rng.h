@@ -0,0 +1,55 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * Structure holding the state of a pseudo-random number stream. Streams are
+ * independent of each other and of rand(), so results are reproducible from a seed
+ * regardless of what else draws random numbers.
+ */
+typedef struct {
+    uint32_t state;
+} rng_t;
+
+/** Stream used for random decisions during a game */
+extern rng_t game_rng;
+
+/**
+ * Seed a stream. Nearby seeds (e.g. consecutive indices) give unrelated streams.
+ *
+ * @param rng  Stream to seed
+ * @param seed Seed value
+ */
+void rng_seed(rng_t* rng, uint32_t seed);
+
+/**
+ * Seed a stream from a base seed and a sub-stream index, for example one stream per
+ * generated layout so that results do not depend on how work is split up.
+ *
+ * @param rng   Stream to seed
+ * @param seed  Base seed value
+ * @param index Sub-stream index
+ */
+void rng_seed_stream(rng_t* rng, uint32_t seed, uint32_t index);
+
+/**
+ * Get the next 16 random bits from a stream.
+ *
+ * @param  rng Stream to draw from
+ * @return     Random value
+ */
+uint16_t rng_next(rng_t* rng);
+
+/**
+ * Get a random value in the range [0, n).
+ *
+ * @param  rng Stream to draw from
+ * @param  n   Exclusive upper bound, must be greater than 0
+ * @return     Random value
+ */
+uint16_t rng_uniform(rng_t* rng, uint16_t n);
+
+#endif // RNG_H
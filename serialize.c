@@ -0,0 +1,342 @@
+#include <string.h>
+
+#include "serialize.h"
+
+/**
+ * Structure holding the position of a bit stream over a buffer, bits are stored
+ * from the least significant bit of each byte.
+ */
+typedef struct {
+    uint8_t* buf;
+    const uint8_t* in;
+    uint16_t size;
+    uint16_t bit;
+    bool overflow; // Set if the stream ran past the end of the buffer
+} bit_stream_t;
+
+/* Function Prototypes */
+void write_bits(bit_stream_t* stream, uint16_t value, uint8_t count);
+uint16_t read_bits(bit_stream_t* stream, uint8_t count);
+uint16_t finish_stream(bit_stream_t* stream);
+bool write_header(bit_stream_t* stream, uint8_t kind);
+bool read_header(bit_stream_t* stream, uint8_t kind);
+void write_player(bit_stream_t* stream, player_t* player);
+bool read_player(bit_stream_t* stream, player_t* player);
+void write_dimensions(bit_stream_t* stream, grid_t* grid);
+bool read_dimensions(bit_stream_t* stream, grid_t* grid);
+
+
+uint16_t serialize_grid(uint8_t* buf, uint16_t size, grid_t* grid) {
+    bit_stream_t stream = {.buf = buf, .size = size};
+    if (!write_header(&stream, SERIAL_KIND_GRID)) {
+        return 0;
+    }
+    write_dimensions(&stream, grid);
+
+    // Use only as many bits as the largest reference needs
+    uint8_t max_ref = 0;
+    for (int8_t y = 0; y < grid->height; y++) {
+        grid_iter_t iter = grid_row_iter(grid, y);
+        for (int8_t x = 0; x < grid->width; x++) {
+            uint8_t ref = grid_iter_next(&iter);
+            if (ref > max_ref) {
+                max_ref = ref;
+            }
+        }
+    }
+    uint8_t ref_bits = 0;
+    while (max_ref >> ref_bits) {
+        ref_bits++;
+    }
+    write_bits(&stream, ref_bits, SERIAL_REF_BITS);
+
+    for (int8_t y = 0; y < grid->height; y++) {
+        grid_iter_t iter = grid_row_iter(grid, y);
+        for (int8_t x = 0; x < grid->width; x++) {
+            write_bits(&stream, grid_iter_next(&iter), ref_bits);
+            write_bits(&stream, bb_test(&grid->shot, x, y), 1);
+            write_bits(&stream, bb_test(&grid->destroyed, x, y), 1);
+        }
+    }
+    return finish_stream(&stream);
+}
+
+
+bool deserialize_grid(const uint8_t* buf, uint16_t length, grid_t* grid) {
+    bit_stream_t stream = {.in = buf, .size = length};
+    if (!read_header(&stream, SERIAL_KIND_GRID) || !read_dimensions(&stream, grid)) {
+        return false;
+    }
+    uint8_t ref_bits = read_bits(&stream, SERIAL_REF_BITS);
+    if (ref_bits > 8) {
+        return false;
+    }
+
+    zero_grid_data(grid);
+    for (int8_t y = 0; y < grid->height; y++) {
+        for (int8_t x = 0; x < grid->width; x++) {
+            g_data data = read_bits(&stream, ref_bits);
+            if (data > MAX_POS_DATA) {
+                return false;
+            }
+            if (read_bits(&stream, 1)) {
+                data |= SHOT_POS;
+            }
+            if (read_bits(&stream, 1)) {
+                data |= DESTROY_POS;
+            }
+            set_grid_data(grid, x, y, data);
+        }
+    }
+    // Every position holding a ship is part of a placed ship
+    bb_dilate(&grid->occupied, grid->width, grid->height, &grid->halo);
+    return !stream.overflow;
+}
+
+
+uint16_t serialize_game(uint8_t* buf, uint16_t size, game_t* game) {
+    bit_stream_t stream = {.buf = buf, .size = size};
+    if (!write_header(&stream, SERIAL_KIND_GAME)) {
+        return 0;
+    }
+    if (game->player_one->ship_count > SERIAL_MAX_SHIPS || game->player_two->ship_count > SERIAL_MAX_SHIPS) {
+        return 0;
+    }
+    write_bits(&stream, game->turn == PLAYER_TWO, 1);
+    write_bits(&stream, game->shots, SERIAL_SHOTS_BITS);
+    write_bits(&stream, placement_rule == RuleNoTouch, 1);
+    write_player(&stream, game->player_one);
+    write_player(&stream, game->player_two);
+    return finish_stream(&stream);
+}
+
+
+bool deserialize_game(const uint8_t* buf, uint16_t length, game_t* game) {
+    bit_stream_t stream = {.in = buf, .size = length};
+    if (!read_header(&stream, SERIAL_KIND_GAME)) {
+        return false;
+    }
+    bool turn_two = read_bits(&stream, 1);
+    uint16_t shots = read_bits(&stream, SERIAL_SHOTS_BITS);
+    placement_rule_t rule = read_bits(&stream, 1) ? RuleNoTouch : RuleMayTouch;
+
+    // Ships are validated under the game's rule, the caller's rule is kept if decoding fails
+    placement_rule_t caller_rule = placement_rule;
+    placement_rule = rule;
+    if (!read_player(&stream, game->player_one) || !read_player(&stream, game->player_two)) {
+        placement_rule = caller_rule;
+        return false;
+    }
+    game->turn = turn_two ? PLAYER_TWO : PLAYER_ONE;
+    game->shots = shots;
+    return true;
+}
+
+
+/**
+ * Write a player's state to a stream.
+ *
+ * @param stream Stream to write to
+ * @param player Player to write
+ */
+void write_player(bit_stream_t* stream, player_t* player) {
+    grid_t* grid = player->grid;
+    write_bits(stream, player->cpu, 1);
+    bool has_last = player->last_x >= 0 && player->last_y >= 0;
+    write_bits(stream, has_last, 1);
+    write_bits(stream, has_last ? player->last_x : 0, SERIAL_COORD_BITS);
+    write_bits(stream, has_last ? player->last_y : 0, SERIAL_COORD_BITS);
+    write_dimensions(stream, grid);
+
+    // Ship references are their index so only the length and position are needed
+    write_bits(stream, player->ship_count, SERIAL_COUNT_BITS);
+    for (uint8_t idx = 0; idx < player->ship_count; idx++) {
+        ship_t* ship = &player->ships[idx];
+        write_bits(stream, ship->length, SERIAL_COORD_BITS);
+        write_bits(stream, ship->placed, 1);
+        if (ship->placed) {
+            write_bits(stream, ship->x, SERIAL_COORD_BITS);
+            write_bits(stream, ship->y, SERIAL_COORD_BITS);
+            write_bits(stream, ship->dir, SERIAL_DIR_BITS);
+        }
+    }
+
+    // Ship data, hits and destroys follow from the ships and the shots
+    for (uint8_t y = 0; y < grid->height; y++) {
+        bb_row_t row = grid->shot.rows[y];
+        for (uint8_t x = 0; x < grid->width; x++, row >>= 1) {
+            write_bits(stream, row & 1, 1);
+        }
+    }
+}
+
+
+/**
+ * Read a player's state from a stream, placing its ships and replaying the shots on it.
+ *
+ * @param  stream Stream to read from
+ * @param  player Player to update
+ * @return        Whether the state was valid for the player
+ */
+bool read_player(bit_stream_t* stream, player_t* player) {
+    grid_t* grid = player->grid;
+    player->cpu = read_bits(stream, 1);
+    bool has_last = read_bits(stream, 1);
+    int8_t last_x = read_bits(stream, SERIAL_COORD_BITS);
+    int8_t last_y = read_bits(stream, SERIAL_COORD_BITS);
+    player->last_x = has_last ? last_x : BLOCKED_POS;
+    player->last_y = has_last ? last_y : BLOCKED_POS;
+    if (!read_dimensions(stream, grid) || read_bits(stream, SERIAL_COUNT_BITS) != player->ship_count) {
+        return false;
+    }
+    if (has_last && (last_x >= grid->width || last_y >= grid->height)) {
+        return false;
+    }
+
+    zero_grid_data(grid);
+    for (uint8_t idx = 0; idx < player->ship_count; idx++) {
+        ship_t* ship = &player->ships[idx];
+        ship->length = read_bits(stream, SERIAL_COORD_BITS);
+        if (ship->length != pgm_read_byte(&player->fleet[idx].length)) {
+            return false;
+        }
+        ship->hits = 0;
+        ship->placed = false;
+        if (read_bits(stream, 1)) {
+            ship->x = read_bits(stream, SERIAL_COORD_BITS);
+            ship->y = read_bits(stream, SERIAL_COORD_BITS);
+            ship->dir = read_bits(stream, SERIAL_DIR_BITS);
+            if (stream->overflow || !place_ship(grid, ship, get_ship_ref(idx), true)) {
+                return false;
+            }
+        }
+    }
+
+    for (int8_t y = 0; y < grid->height; y++) {
+        for (int8_t x = 0; x < grid->width; x++) {
+            if (read_bits(stream, 1)) {
+                shoot_pos(player, x, y);
+            }
+        }
+    }
+    return !stream->overflow;
+}
+
+
+/**
+ * Write the dimensions of a grid to a stream.
+ *
+ * @param stream Stream to write to
+ * @param grid   Grid to write dimensions of
+ */
+void write_dimensions(bit_stream_t* stream, grid_t* grid) {
+    write_bits(stream, grid->width - 1, SERIAL_COORD_BITS);
+    write_bits(stream, grid->height - 1, SERIAL_COORD_BITS);
+}
+
+
+/**
+ * Read grid dimensions from a stream and check they match a grid.
+ *
+ * @param  stream Stream to read from
+ * @param  grid   Grid that is being decoded into
+ * @return        Whether the dimensions match
+ */
+bool read_dimensions(bit_stream_t* stream, grid_t* grid) {
+    uint8_t width = read_bits(stream, SERIAL_COORD_BITS) + 1;
+    uint8_t height = read_bits(stream, SERIAL_COORD_BITS) + 1;
+    return !stream->overflow && width == grid->width && height == grid->height;
+}
+
+
+/**
+ * Write the version and kind byte that starts an encoding.
+ *
+ * @param  stream Stream to write to, must be at its start
+ * @param  kind   Kind of encoding
+ * @return        Whether the header fitted
+ */
+bool write_header(bit_stream_t* stream, uint8_t kind) {
+    write_bits(stream, SERIAL_VERSION, 4);
+    write_bits(stream, kind, 4);
+    return !stream->overflow;
+}
+
+
+/**
+ * Read and check the version and kind byte that starts an encoding.
+ *
+ * @param  stream Stream to read from, must be at its start
+ * @param  kind   Kind of encoding expected
+ * @return        Whether the header is for this version and kind
+ */
+bool read_header(bit_stream_t* stream, uint8_t kind) {
+    uint8_t version = read_bits(stream, 4);
+    return !stream->overflow && version == SERIAL_VERSION && read_bits(stream, 4) == kind;
+}
+
+
+/**
+ * Append the low bits of a value to a stream. Bits past the end of the buffer are dropped
+ * and flag the stream as overflowed.
+ *
+ * @param stream Stream to write to
+ * @param value  Value to write
+ * @param count  Number of bits to write
+ */
+void write_bits(bit_stream_t* stream, uint16_t value, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++, stream->bit++) {
+        uint16_t byte = stream->bit >> 3;
+        if (byte >= stream->size) {
+            stream->overflow = true;
+            return;
+        }
+        uint8_t mask = 1 << (stream->bit & 7);
+        if (value & (1 << i)) {
+            stream->buf[byte] |= mask;
+        } else {
+            stream->buf[byte] &= ~mask;
+        }
+    }
+}
+
+
+/**
+ * Take the next bits of a stream as a value. Bits past the end of the buffer read as 0
+ * and flag the stream as overflowed.
+ *
+ * @param  stream Stream to read from
+ * @param  count  Number of bits to read
+ * @return        Value read
+ */
+uint16_t read_bits(bit_stream_t* stream, uint8_t count) {
+    uint16_t value = 0;
+    for (uint8_t i = 0; i < count; i++, stream->bit++) {
+        uint16_t byte = stream->bit >> 3;
+        if (byte >= stream->size) {
+            stream->overflow = true;
+            return value;
+        }
+        if (stream->in[byte] & (1 << (stream->bit & 7))) {
+            value |= 1 << i;
+        }
+    }
+    return value;
+}
+
+
+/**
+ * Get the number of bytes a stream has written to, padding the last byte with 0's.
+ *
+ * @param  stream Stream that has been written
+ * @return        Number of bytes used, 0 if the stream overflowed
+ */
+uint16_t finish_stream(bit_stream_t* stream) {
+    if (stream->overflow) {
+        return 0;
+    }
+    while (stream->bit & 7) {
+        write_bits(stream, 0, 1);
+    }
+    return stream->bit >> 3;
+}
@@ -0,0 +1,88 @@
+#ifndef SERIALIZE_H
+#define SERIALIZE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "grid.h"
+#include "player.h"
+#include "game.h"
+
+/* Encodings start with a byte holding the format version (low nibble) and kind (high nibble) */
+#define SERIAL_VERSION     (2)
+#define SERIAL_KIND_GRID   (1)
+#define SERIAL_KIND_GAME   (2)
+
+/* Field widths in bits, coordinates and dimensions (stored less one) cover GRID_MAX_SIZE */
+#define SERIAL_COORD_BITS  (5)
+#define SERIAL_COUNT_BITS  (4) // Ships per player
+#define SERIAL_REF_BITS    (4) // Number of bits per position reference
+#define SERIAL_DIR_BITS    (2)
+#define SERIAL_SHOTS_BITS  (11) // Shots in a game, both players shooting every position of a GRID_MAX_SIZE grid
+#define SERIAL_MAX_SHIPS   ((1 << SERIAL_COUNT_BITS) - 1)
+
+/* Bits used by a player: cpu, last shot, dimensions, ship count, ships and the shot plane */
+#define SERIAL_PLAYER_BITS(width, height, ship_count) \
+    (1 + 1 + 4 * SERIAL_COORD_BITS + SERIAL_COUNT_BITS + \
+    (ship_count) * (SERIAL_COORD_BITS + 1 + 2 * SERIAL_COORD_BITS + SERIAL_DIR_BITS) + (width) * (height))
+
+/* Largest number of bytes an encoded game can take, for sizing buffers */
+#define SERIAL_GAME_SIZE(width, height, ship_count) \
+    ((8 + 1 + SERIAL_SHOTS_BITS + 1 + 2 * SERIAL_PLAYER_BITS(width, height, ship_count) + 7) / 8)
+
+/* Largest number of bytes an encoded grid can take, for sizing buffers */
+#define SERIAL_GRID_SIZE(width, height) \
+    ((8 + 2 * SERIAL_COORD_BITS + SERIAL_REF_BITS + (width) * (height) * (8 + 2) + 7) / 8)
+
+/**
+ * Encode the state of a grid: its dimensions, the data (ship reference) of each position
+ * and the shot and destroyed planes. References are packed with as few bits as the largest
+ * reference needs.
+ *
+ * @param  buf  Buffer to write encoding into
+ * @param  size Size of the buffer
+ * @param  grid Grid to encode
+ * @return      Number of bytes written, 0 if the buffer is too small
+ */
+uint16_t serialize_grid(uint8_t* buf, uint16_t size, grid_t* grid);
+
+/**
+ * Decode a grid encoded with serialize_grid. No memory is allocated, the grid must already
+ * hold data for the encoded dimensions. The halo is rebuilt from the decoded ships.
+ *
+ * @param  buf    Encoding to decode
+ * @param  length Length of the encoding
+ * @param  grid   Grid to update
+ * @return        Whether the encoding was valid for the grid
+ */
+bool deserialize_grid(const uint8_t* buf, uint16_t length, grid_t* grid);
+
+/**
+ * Encode the state of a game: the turn, shot count and placement rule then, for each player,
+ * whether it is a CPU, its last shot, its dimensions, its fleet with ship positions and the
+ * positions shot on its grid. Ship data, hits and destroyed positions follow from these so
+ * are not stored, and ships are only described by length. A default game takes 57 bytes.
+ *
+ * @param  buf  Buffer to write encoding into
+ * @param  size Size of the buffer, SERIAL_GAME_SIZE is always sufficient
+ * @param  game Game to encode
+ * @return      Number of bytes written, 0 if the buffer is too small or the game cannot be encoded
+ */
+uint16_t serialize_game(uint8_t* buf, uint16_t size, game_t* game);
+
+/**
+ * Decode a game encoded with serialize_game. No memory is allocated, the game's players must
+ * already have grids of the encoded dimensions and the encoded number of ships. Ship names and
+ * lengths come from each player's fleet, which encoded lengths must match. Ships are validated under the game's placement rule,
+ * which becomes the placement rule only if decoding succeeds. Shots are replayed so ship hits
+ * and destroyed positions are restored.
+ *
+ * @param  buf    Encoding to decode
+ * @param  length Length of the encoding
+ * @param  game   Game to update, only valid if decoding succeeds
+ * @return        Whether the encoding was valid for the game
+ */
+bool deserialize_game(const uint8_t* buf, uint16_t length, game_t* game);
+
+#endif // SERIALIZE_H
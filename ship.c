@@ -1,122 +1,246 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <stdbool.h>
 
 #include "ship.h"
+#include "layout.h"
 
+placement_rule_t placement_rule = RuleMayTouch;
 
-void print_ships(ship_t ships[], uint8_t count) {
-    printf("Ships:\n");
+/** Ship names, indexed by ship_name_t */
+static const char str_unnamed[]    PROGMEM = "";
+static const char str_destroyer[]  PROGMEM = "Destroyer";
+static const char str_submarine[]  PROGMEM = "Submarine";
+static const char str_cruiser[]    PROGMEM = "Cruiser";
+static const char str_battleship[] PROGMEM = "Battleship";
+static const char str_carrier[]    PROGMEM = "Carrier";
+static PGM_P const ship_names[ShipNameCount] PROGMEM = {
+    str_unnamed, str_destroyer, str_submarine, str_cruiser, str_battleship, str_carrier
+};
+
+
+PGM_P get_ship_name(const ship_def_t* def) {
+    uint8_t name = pgm_read_byte(&def->name);
+    return pgm_read_ptr(&ship_names[name < ShipNameCount ? name : ShipUnnamed]);
+}
+
+
+void make_ship(ship_t* ship, const ship_def_t* def) {
+    *ship = (ship_t) {.length = pgm_read_byte(&def->length), SHIP_DEFAULTS};
+}
+
+
+void print_ships(const ship_def_t fleet[], ship_t ships[], uint8_t count) {
+    char name[SHIP_NAME_SIZE];
+    printf_P(PSTR("Ships:\n"));
     for (uint8_t ship = 0; ship < count; ship++) {
-        printf("  (%d) %-10s - X:%d, Y:%d, D:%d, L:%d, H:%d\n",
-               ships[ship].ref, ships[ship].name, ships[ship].x,
+        strcpy_P(name, get_ship_name(&fleet[ship]));
+        printf_P(PSTR("  (%d) %-10s - X:%d, Y:%d, D:%d, L:%d, H:%d\n"),
+               get_ship_ref(ship), name, ships[ship].x,
                ships[ship].y, ships[ship].dir, ships[ship].length, ships[ship].hits);
     }
 }
 
 bool auto_place_ships(grid_t* grid, ship_t ships[], uint8_t count) {
-    bool allplaced = false;
-    // Allocate data for auto grid placements
-    grid_t alloc_grid = {.width = grid->width, .height = grid->height};
-    allocate_grid_data(&alloc_grid, false);
-
-    if (alloc_grid.data != NULL) {
-        // Auto place ships
-        allplaced = true;
-        for (uint8_t ship = 0; ship < count; ship++) {
-            bool placed = auto_place_ship(grid, &alloc_grid, &ships[ship]);
-            allplaced &= placed;
-        };
-        free(alloc_grid.data);
-    }
-
-    return allplaced;
-}
-
-bool auto_place_ship(grid_t* ship_grid, grid_t* alloc_grid, ship_t* ship) {
-    uint16_t available = gen_availability_grid(ship_grid, alloc_grid, ship->length);
-    if (available > 0) {
-        uint16_t allocation = 1 + rand() % available;
-        if (allocate_ship_pos(alloc_grid, ship, allocation)) {
-            place_ship(ship_grid, ship, false);
-            return true;
-        }
-    }
-    return false;
+    return is_layout_placed(sample_layout(grid, ships, count, LayoutUniform, &game_rng));
 }
 
-bool allocate_ship_pos(grid_t* alloc_grid, ship_t* ship, uint16_t allocation) {
-    uint16_t ongoing = 0;
+bool allocate_ship_pos(avail_masks_t* avail, ship_t* ship, uint16_t allocation) {
     if (allocation > 0) {
-        for (ship->x = 0; ship->x < alloc_grid->width; ship->x++) {
-            for (ship->y = 0; ship->y < alloc_grid->height; ship->y++) {
-                g_data data = get_grid_data(alloc_grid, ship->x, ship->y);
-                for (ship->dir = D_North; ship->dir <= D_West; ship->dir++) {
-                    // Check if flag is set
-                    if (data & (1 << ship->dir)) {
-                        ongoing++;
-                        if (ongoing == allocation) {
-                            // Allocation found
-                            return true;
-                        }
-                    }
+        for (dir_t dir = D_North; dir <= D_West; dir++) {
+            for (uint8_t y = 0; y < avail->height; y++) {
+                uint8_t count = avail->row_count[dir][y];
+                if (allocation > count) {
+                    // Skip the whole row
+                    allocation -= count;
+                    continue;
                 }
+                // Allocation found in this row
+                ship->dir = dir;
+                ship->y = y;
+                ship->x = bb_row_select(avail->dir[dir].rows[y], allocation);
+                return true;
             }
         }
     }
     return false;
 }
 
-uint16_t gen_availability_grid(grid_t* ship_grid, grid_t* alloc_grid, uint8_t length) {
-    uint16_t count = 0;
-    ship_t ship = {.length = length};
-    for (ship.x = 0; ship.x < ship_grid->width; ship.x++) {
-        for (ship.y = 0; ship.y < ship_grid->height; ship.y++) {
-            // Clear current allocation
-            int16_t pos = map_grid_pos(alloc_grid, ship.x, ship.y);
-            alloc_grid->data[pos] = 0;
-            for (ship.dir = D_North; ship.dir <= D_West; ship.dir++) {
-                // Set the direction bit high if placeable
-                if (place_ship_valid(ship_grid, &ship)) {
-                    alloc_grid->data[pos] |= 1 << ship.dir;
-                    count++;
-                }
-            }
+uint16_t gen_availability_masks(bitboard_t* occupied, uint8_t width, uint8_t height, uint8_t length,
+    avail_masks_t* avail) {
+    bb_row_t row_mask = bb_row_mask(width);
+    avail->height = height;
+    avail->count = 0;
+
+    for (uint8_t y = 0; y < height; y++) {
+        bb_row_t empty = ~occupied->rows[y] & row_mask;
+        bb_row_t north = empty;
+        bb_row_t east  = empty;
+        bb_row_t south = empty;
+        bb_row_t west  = empty;
+        // An origin is available if every position the ship would cover is empty
+        for (uint8_t i = 1; i < length; i++) {
+            north &= i <= y ? ~occupied->rows[y - i] : 0;
+            east  &= empty >> i;
+            south &= y + i < height ? ~occupied->rows[y + i] : 0;
+            west  &= empty << i;
         }
+        avail->dir[D_North].rows[y] = north;
+        avail->dir[D_East].rows[y]  = east;
+        avail->dir[D_South].rows[y] = south;
+        avail->dir[D_West].rows[y]  = west;
+
+        for (dir_t dir = D_North; dir <= D_West; dir++) {
+            uint8_t count = bb_row_popcount(avail->dir[dir].rows[y]);
+            avail->row_count[dir][y] = count;
+            avail->count += count;
+        }
+    }
+    return avail->count;
+}
+
+uint8_t get_valid_rotations(avail_masks_t* avail, int8_t x, int8_t y) {
+    uint8_t rotations = 0;
+    if (x >= 0 && y >= 0 && x < BB_ROW_BITS && y < avail->height) {
+        for (dir_t dir = D_North; dir <= D_West; dir++) {
+            rotations |= bb_test(&avail->dir[dir], x, y) << dir;
+        }
+    }
+    return rotations;
+}
+
+uint8_t get_on_grid_rotations(grid_t* grid, int8_t x, int8_t y, uint8_t length) {
+    if (x < 0 || y < 0 || x >= grid->width || y >= grid->height) {
+        return 0;
     }
-    return count;
+    uint8_t span = length - 1;
+    uint8_t rotations = 0;
+    rotations |= (y >= span) << D_North;
+    rotations |= (x + span < grid->width) << D_East;
+    rotations |= (y + span < grid->height) << D_South;
+    rotations |= (x >= span) << D_West;
+    return rotations;
 }
 
-bool place_ship(grid_t* grid, ship_t* ship, bool verify) {
+bitboard_t* get_blocked_bitboard(grid_t* grid) {
+    return placement_rule == RuleNoTouch ? &grid->halo : &grid->occupied;
+}
+
+void gen_blocked_bitboard(bitboard_t* occupied, uint8_t width, uint8_t height, bitboard_t* blocked) {
+    if (placement_rule == RuleNoTouch) {
+        bb_dilate(occupied, width, height, blocked);
+    } else if (blocked != occupied) {
+        *blocked = *occupied;
+    }
+}
+
+void block_ship_on_bitboard(bitboard_t* bb, ship_t* ship, uint8_t width, uint8_t height) {
+    if (placement_rule == RuleNoTouch) {
+        add_ship_halo_to_bitboard(bb, ship, width, height);
+    } else {
+        add_ship_to_bitboard(bb, ship);
+    }
+}
+
+void add_ship_halo_to_bitboard(bitboard_t* bb, ship_t* ship, uint8_t width, uint8_t height) {
+    int8_t x, y;
+    bb_row_t row = get_ship_row_mask(ship, &x, &y);
+    row = (row | (row << 1) | (row >> 1)) & bb_row_mask(width);
+    int8_t first = y > 0 ? y - 1 : 0;
+    int8_t last = y + (is_ship_horizontal(ship) ? 1 : ship->length);
+    if (last >= height) {
+        last = height - 1;
+    }
+    for (int8_t i = first; i <= last; i++) {
+        bb->rows[i] |= row;
+    }
+}
+
+void add_ship_to_bitboard(bitboard_t* bb, ship_t* ship) {
+    int8_t x, y;
+    bb_row_t row = get_ship_row_mask(ship, &x, &y);
+    uint8_t rows = is_ship_horizontal(ship) ? 1 : ship->length;
+    for (uint8_t i = 0; i < rows; i++) {
+        bb->rows[y + i] |= row;
+    }
+}
+
+void remove_ship_from_bitboard(bitboard_t* bb, ship_t* ship) {
+    int8_t x, y;
+    bb_row_t row = get_ship_row_mask(ship, &x, &y);
+    uint8_t rows = is_ship_horizontal(ship) ? 1 : ship->length;
+    for (uint8_t i = 0; i < rows; i++) {
+        bb->rows[y + i] &= ~row;
+    }
+}
+
+bool ship_overlaps_bitboard(bitboard_t* bb, ship_t* ship) {
+    int8_t x, y;
+    bb_row_t row = get_ship_row_mask(ship, &x, &y);
+    uint8_t rows = is_ship_horizontal(ship) ? 1 : ship->length;
+    for (uint8_t i = 0; i < rows; i++) {
+        if (bb->rows[y + i] & row) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bb_row_t get_ship_row_mask(ship_t* ship, int8_t* top_x, int8_t* top_y) {
+    *top_x = ship->x;
+    *top_y = ship->y;
+    // Normalise to the top left position covered
+    if (ship->dir == D_North || ship->dir == D_West) {
+        move_x_y_n(top_x, top_y, ship->dir, ship->length - 1);
+    }
+    uint8_t width = is_ship_horizontal(ship) ? ship->length : 1;
+    return bb_row_mask(width) << *top_x;
+}
+
+bool is_ship_horizontal(ship_t* ship) {
+    return ship->dir == D_East || ship->dir == D_West;
+}
+
+bool place_ship(grid_t* grid, ship_t* ship, uint8_t ref, bool verify) {
     if (verify && !place_ship_valid(grid, ship)) {
         return false;
     }
-    int8_t x = ship->x;
-    int8_t y = ship->y;
-    for (uint8_t i = 0; i < ship->length; i++) {
-        set_grid_data(grid, x, y, (g_data) ship->ref);
-        move_x_y(&x, &y, ship->dir);
+    // The ship is on the grid so the data plane can be stepped through unchecked
+    grid_index_t index = get_grid_index(grid, ship->x, ship->y);
+    grid_index_t stride = get_dir_stride(grid, ship->dir);
+    for (uint8_t i = 0; i < ship->length; i++, index += stride) {
+        set_plane_data(grid, index, ref);
     }
+    add_ship_to_bitboard(&grid->occupied, ship);
+    add_ship_halo_to_bitboard(&grid->halo, ship, grid->width, grid->height);
+    invalidate_grid_journal(grid);
     ship->placed = true;
     return true;
 }
 
 place_valid_t validate_ship_position(grid_t* grid, ship_t* ship) {
-    int8_t x = ship->x;
-    int8_t y = ship->y;
-    place_valid_t validation = PlaceValid;
-
-    for (uint8_t i = 0; i < ship->length; i++) {
-        g_data data = get_grid_data(grid, x, y);
+    if (!(get_on_grid_rotations(grid, ship->x, ship->y, ship->length) & (1 << ship->dir))) {
+        return OffGrid;
+    } else if (ship_overlaps_bitboard(&grid->occupied, ship)) {
+        return Overlap;
+    } else if (placement_rule == RuleNoTouch && ship_overlaps_bitboard(&grid->halo, ship)) {
+        return Touching;
+    }
+    return PlaceValid;
+}
 
-        if (data == BLOCKED_POS) {
-            return OffGrid;
-        } else if (data & POS_DATA) {
-            validation = Overlap;
-        }
-        move_x_y(&x, &y, ship->dir);
+grid_index_t get_dir_stride(grid_t* grid, dir_t dir) {
+    switch (dir) {
+    case D_North:
+        return -get_grid_stride_y(grid);
+    case D_East:
+        return get_grid_stride_x(grid);
+    case D_South:
+        return get_grid_stride_y(grid);
+    default:
+        return -get_grid_stride_x(grid);
     }
-    return validation;
 }
 
 bool is_ship_destroyed(ship_t* ship) {
@@ -5,15 +5,23 @@
 #include <stdbool.h>
 
 #include "grid.h"
+#include "bitboard.h"
+#include "flash.h"
 
 /* Default clear values for non-property values */
 #define SHIP_DEFAULTS .hits = 0, .x = 0, .y = 0, .dir = D_South, .placed = false
 #define NO_DIR (0xFF)
+#define SHIP_NAME_SIZE (11) // Longest ship name including its terminator
+#define SHIP_FIELD_BITS (5) // Bits for a coordinate, length or hit count, covers GRID_MAX_SIZE
 
 /* Wrapper macrocs for methods */
 #define place_ship_valid(grid, ship) (!validate_ship_position(grid, ship))
 #define move_x_y(x, y, dir) (move_x_y_n(x, y, dir, 1))
 
+/* Ships are referenced on a grid by their index in their fleet plus one */
+#define get_ship_ref(idx) ((idx) + 1)
+#define get_ship_idx(ref) ((ref) - 1)
+
 /**
  * Enumeration of directions.
  */
@@ -25,40 +33,102 @@ typedef enum {
 } dir_t;
 
 /**
- * Structure holding a ships identifying data, positioning data and
- * its current state.
+ * Enumeration of ship names, indexes into the ship name table held in flash.
+ */
+typedef enum {
+    ShipUnnamed, // Ships without a fleet definition (e.g. from a host tool or the link)
+    ShipDestroyer,
+    ShipSubmarine,
+    ShipCruiser,
+    ShipBattleship,
+    ShipCarrier,
+    ShipNameCount
+} ship_name_t;
+
+/**
+ * Structure holding the fixed properties of a ship. A fleet is an array of these held in
+ * program memory, shared by every player using it and read with get_ship_name/make_ship.
  */
 typedef struct {
-    const char* name;
-    int8_t ref;
-    int8_t x;
-    int8_t y;
-    dir_t dir;
+    uint8_t name; // Index into the ship name table (ship_name_t)
     uint8_t length;
-    uint8_t hits;
-    bool placed;
+} ship_def_t;
+
+/**
+ * Structure holding a ships positioning data and its current state, packed into three bytes.
+ * Its identity comes from its position in the fleet (see get_ship_ref). Coordinates can only
+ * hold positions on a grid, off grid positions must be checked before being stored.
+ */
+typedef struct __attribute__((packed)) {
+    uint16_t x      : SHIP_FIELD_BITS;
+    uint16_t y      : SHIP_FIELD_BITS;
+    dir_t dir       : 2;
+    bool placed     : 1;
+    uint16_t length : SHIP_FIELD_BITS;
+    uint16_t hits   : SHIP_FIELD_BITS;
 } ship_t;
 
+/**
+ * Structure holding, for each direction, which origins support a ship of a given length.
+ * Set bits in the direction bitboards are available placements, the per-row counts allow
+ * the n'th placement to be found without scanning every position.
+ */
+typedef struct {
+    bitboard_t dir[D_West + 1];
+    uint8_t row_count[D_West + 1][BB_MAX_HEIGHT];
+    uint8_t height;
+    uint16_t count;
+} avail_masks_t;
+
 /**
  * Enumeration of placement validation results.
  */
 typedef enum {
     PlaceValid,
     OffGrid,
-    Overlap
+    Overlap,
+    Touching
 } place_valid_t;
 
 /**
- * Print the states of the given ship list.
+ * Enumeration of rules restricting where ships can be placed relative to each other.
+ */
+typedef enum {
+    RuleMayTouch, // Ships may be placed next to each other
+    RuleNoTouch   // Ships may not be next to each other, including diagonally
+} placement_rule_t;
+
+/* Rule applied to all ship placements, should only be changed between games */
+extern placement_rule_t placement_rule;
+
+/**
+ * Get the name of a fleet's ship from the ship name table.
  *
+ * @param  def Fleet definition of the ship, in program memory
+ * @return     Name in program memory, empty if the ship is unnamed
+ */
+PGM_P get_ship_name(const ship_def_t* def);
+
+/**
+ * Initialise a ship from its fleet definition, it will be unplaced with no hits.
+ *
+ * @param ship Ship to initialise
+ * @param def  Fleet definition of the ship, in program memory
+ */
+void make_ship(ship_t* ship, const ship_def_t* def);
+
+/**
+ * Print the states of the given ship list, named from their fleet definition.
+ *
+ * @param fleet Fleet definition of the ships, in program memory
  * @param ships Ship array
  * @param count Number of ships in array
  */
-void print_ships(ship_t ships[], uint8_t count);
+void print_ships(const ship_def_t fleet[], ship_t ships[], uint8_t count);
 
 /**
  * Using a grid that may be filled with ships as a basis, attempt to place the provided list of ships randomly.
- * This requires a memory allocation equal to that of the provided grid.
+ * Layouts are sampled uniformly using sample_layout, so either all ships are placed or none are.
  * 
  * @param  grid  Currently placed ships (no shot bits allowed to be set)
  * @param  ships Ships to attempt to auto-place
@@ -68,59 +138,160 @@ void print_ships(ship_t ships[], uint8_t count);
 bool auto_place_ships(grid_t* grid, ship_t ships[], uint8_t count);
 
 /**
- * Using a grid filled with ships as a basis, attempt to place another ship randomly. If possible, the
- * ship's positioning fields are set and the ship will be placed on the ship_grid.
+ * Using pre-generated availability masks, attempt to allocate a position and direction to a given ship.
+ * Each set bit is counted as an available allocation, in direction then row then column order.
+ * The selected bit is the n'th one (where n == allocation), found by skipping whole rows using
+ * their counts and then selecting within a single row.
  *
- * @param  ship_grid  Currently placed ships (no shot bits allowed to be set)
- * @param  alloc_grid Grid with pre-allocated memory equal in size to ship_grid (will be cleared)
- * @param  ship       Ship to attempt to auto-place
- * @return            Whether ship could be auto-placed
- */
-bool auto_place_ship(grid_t* ship_grid, grid_t* alloc_grid, ship_t* ship);
-
-/**
- * Using an allocation grid, attempt to allocate a position and direction to a given ship.
- * This is achieved by counting each set flag in the allocation grid as an available allocation,
- * The selected flag is the n'th one (where n == allocation).
- *
- * @param  alloc_grid A pre-generated allocation grid
+ * @param  avail      Pre-generated availability masks
  * @param  ship       The ship who's position should be updated
  * @param  allocation Of the allocatable places, the one to select
  * @return            Whether a position was successfully allocated, if this returns false
  *                    the current state of the ship's position fields should be ignored
  */
-bool allocate_ship_pos(grid_t* alloc_grid, ship_t* ship, uint16_t allocation);
+bool allocate_ship_pos(avail_masks_t* avail, ship_t* ship, uint16_t allocation);
+
+/**
+ * Using an occupancy bitboard as a basis, generate a bitboard per direction with bits set for each origin
+ * that supports the given ship length in that direction. A position can be set in multiple directions.
+ *
+ * @param  occupied Positions that ships may not cover (see gen_blocked_bitboard)
+ * @param  width    Width of the grid
+ * @param  height   Height of the grid
+ * @param  length   Length of space required for a placement to be available
+ * @param  avail    Availability masks to fill
+ * @return          The number of available placements
+ */
+uint16_t gen_availability_masks(bitboard_t* occupied, uint8_t width, uint8_t height, uint8_t length,
+    avail_masks_t* avail);
+
+/**
+ * Using pre-generated availability masks, get the directions in which a ship of the masks' length
+ * can be validly placed from an origin.
+ *
+ * @param  avail Pre-generated availability masks
+ * @param  x     x coordinate of the origin
+ * @param  y     y coordinate of the origin
+ * @return       Bit (1 << dir) set for each valid direction
+ */
+uint8_t get_valid_rotations(avail_masks_t* avail, int8_t x, int8_t y);
+
+/**
+ * Get the directions in which a ship of a given length would lie within the bounds of a grid.
+ *
+ * @param  grid   Grid to fit within
+ * @param  x      x coordinate of the origin
+ * @param  y      y coordinate of the origin
+ * @param  length Ship length
+ * @return        Bit (1 << dir) set for each direction that stays on the grid
+ */
+uint8_t get_on_grid_rotations(grid_t* grid, int8_t x, int8_t y, uint8_t length);
+
+/**
+ * Get the bitboard of positions a new ship may not cover on a grid under the current placement rule.
+ * This is the grid's occupancy, or under RuleNoTouch its halo.
+ *
+ * @param  grid Grid with ships placed
+ * @return      Blocked positions
+ */
+bitboard_t* get_blocked_bitboard(grid_t* grid);
+
+/**
+ * Generate the bitboard of positions a new ship may not cover under the current placement rule.
+ * This is the occupancy itself, or under RuleNoTouch the occupancy with its halo.
+ *
+ * @param occupied Occupancy bitboard of currently placed ships
+ * @param width    Width of the grid
+ * @param height   Height of the grid
+ * @param blocked  Bitboard to fill, may be the same as occupied
+ */
+void gen_blocked_bitboard(bitboard_t* occupied, uint8_t width, uint8_t height, bitboard_t* blocked);
 
 /**
- * Using a grid filled with ships as a basis, generate another grid with flags set that represent which directions
- * from the respective position support the given ship length. A position can have multiple flags set if multiple
- * directions are supported
+ * Set the bits a ship stops other ships from covering under the current placement rule.
+ * The ship must lie within the bitboard's grid.
  *
- * Flags:
- * 15-4 [NOTHING], 3 [West], 2 [South], 1 [East], 0 [North]
+ * @param bb     Bitboard to update
+ * @param ship   Ship to add
+ * @param width  Width of the grid
+ * @param height Height of the grid
+ */
+void block_ship_on_bitboard(bitboard_t* bb, ship_t* ship, uint8_t width, uint8_t height);
+
+/**
+ * Set the bits covered by a ship and every position next to it (including diagonally) on a bitboard.
+ * The ship must lie within the bitboard's grid.
+ *
+ * @param bb     Bitboard to update
+ * @param ship   Ship to add
+ * @param width  Width of the grid
+ * @param height Height of the grid
+ */
+void add_ship_halo_to_bitboard(bitboard_t* bb, ship_t* ship, uint8_t width, uint8_t height);
+
+/**
+ * Set the bits covered by a ship on a bitboard. The ship must lie within the bitboard's grid.
  *
- * @param ship_grid  Currently placed ships (no shot bits allowed to be set)
- * @param alloc_grid Grid with pre-allocated memory equal in size to ship_grid (will be cleared)
- * @param length     Length of space required for move to be available
- * @return           The number of available placements
+ * @param bb   Bitboard to update
+ * @param ship Ship to add
  */
-uint16_t gen_availability_grid(grid_t* ship_grid, grid_t* alloc_grid, uint8_t length);
+void add_ship_to_bitboard(bitboard_t* bb, ship_t* ship);
+
+/**
+ * Clear the bits covered by a ship on a bitboard. The ship must lie within the bitboard's grid.
+ *
+ * @param bb   Bitboard to update
+ * @param ship Ship to remove
+ */
+void remove_ship_from_bitboard(bitboard_t* bb, ship_t* ship);
+
+/**
+ * Check whether any bit covered by a ship is set on a bitboard. The ship must lie within
+ * the bitboard's grid.
+ *
+ * @param  bb   Bitboard to check
+ * @param  ship Ship to check
+ * @return      Whether the ship overlaps a set bit
+ */
+bool ship_overlaps_bitboard(bitboard_t* bb, ship_t* ship);
+
+/**
+ * Get the row mask covered by a ship alongside the top left position it covers. A horizontal
+ * ship covers the mask on a single row, a vertical ship covers it on length rows.
+ *
+ * @param  ship  Ship to map
+ * @param  top_x Return pointer for the left-most x coordinate covered
+ * @param  top_y Return pointer for the top-most y coordinate covered
+ * @return       Mask of the columns covered in each row
+ */
+bb_row_t get_ship_row_mask(ship_t* ship, int8_t* top_x, int8_t* top_y);
+
+/**
+ * Check whether a ship lies along a row (East or West) rather than a column.
+ *
+ * @param  ship Ship to check
+ * @return      Whether ship is horizontal
+ */
+bool is_ship_horizontal(ship_t* ship);
 
 /**
  * First verify if the position is valid before placing a ship on the grid.
- * The ship is placed as its reference field in all positions it covers.
+ * The ship is placed as its reference in all positions it covers, on the grid's
+ * occupancy and with its halo on the grid's halo.
  *
  * @param  grid   Grid configuration to update
  * @param  ship   Ship configuration to use for update
+ * @param  ref    Reference of the ship (see get_ship_ref)
  * @param  verify Whether ship placement should be verified first
  * @return        Whether the ship was placed
  */
-bool place_ship(grid_t* grid, ship_t* ship, bool verify);
+bool place_ship(grid_t* grid, ship_t* ship, uint8_t ref, bool verify);
 
 /**
  * Check if a ship can be placed in its stored position on the given grid.
  * A ship must fit within the bounds of the grid and not cross any tile that is
- * not empty.
+ * not empty. Under RuleNoTouch it must also not be next to another ship. The checks are
+ * bounds arithmetic and mask tests against the grid's occupancy and halo.
  *
  * @param  grid Grid configuration to check on
  * @param  ship Ship configuration to check with
@@ -128,6 +299,15 @@ bool place_ship(grid_t* grid, ship_t* ship, bool verify);
  */
 place_valid_t validate_ship_position(grid_t* grid, ship_t* ship);
 
+/**
+ * Get the data plane index step for moving one position in a given direction.
+ *
+ * @param  grid Grid to step through
+ * @param  dir  Direction of step
+ * @return      Index step
+ */
+grid_index_t get_dir_stride(grid_t* grid, dir_t dir);
+
 /**
  * Check if an input ship is in a destroyed state. A destroyed state is where the number of hits equals the
  * number of hitpoints (length).
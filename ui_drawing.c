@@ -9,6 +9,10 @@
 #define DRAW_AREA_LEFT_MARGIN   (10)
 #define DRAW_AREA_RIGHT_MARGIN  (10)
 
+/* Function Prototypes */
+void position_centred_string(const char* text, bool flash, rectangle* rec);
+void reset_view(draw_props_t* view);
+
 /* Define header and footer for external use */
 rectangle header;
 rectangle footer;
@@ -42,8 +46,8 @@ void draw_game_state(game_t* game, draw_props_t* grid_1_draw_props, draw_props_t
     write_current_player(game->turn);
     write_current_turn(game->shots / 2 + 1);
 
-    draw_title("YOUR SHOTS", grid_1_draw_props);
-    draw_title("YOUR SHIPS", grid_2_draw_props);
+    draw_title(PSTR("YOUR SHOTS"), grid_1_draw_props);
+    draw_title(PSTR("YOUR SHIPS"), grid_2_draw_props);
     draw_player_boards(grid_1_draw_props, grid_2_draw_props, next, playing);
 }
 
@@ -59,8 +63,8 @@ void draw_finish_state(game_t* game, draw_props_t* grid_1_draw_props, draw_props
     write_winner(winner);
 
 
-    draw_title("PLAYER " PLAYER_ONE_STR_UP "'S SHIPS", grid_1_draw_props);
-    draw_title("PLAYER " PLAYER_TWO_STR_UP "'S SHIPS", grid_2_draw_props);
+    draw_title(PSTR("PLAYER " PLAYER_ONE_STR_UP "'S SHIPS"), grid_1_draw_props);
+    draw_title(PSTR("PLAYER " PLAYER_TWO_STR_UP "'S SHIPS"), grid_2_draw_props);
     draw_player_boards(grid_1_draw_props, grid_2_draw_props, player_two, player_one);
 }
 
@@ -87,13 +91,13 @@ void draw_footer() {
     stroke_line(footer.left, footer.top - 1, footer.right, footer.top - 1, MESSAGE_BOX_FG);
 }
 
-void write_current_turn(uint8_t turn) {
+void write_current_turn(uint16_t turn) {
     uint16_t temp_bg = display.background;
     uint16_t temp_fg = display.foreground;
     display.background = TITLE_BOX_BG;
     display.foreground = TEXT_COL;
     char buf[20];
-    sprintf(buf, "(Turn %d)", turn);
+    sprintf_P(buf, PSTR("(Turn %u)"), turn);
     display_string_xy(buf, display.width - 60, 7);
 
     display.background = temp_bg;
@@ -106,7 +110,7 @@ void write_current_player(uint8_t player) {
     uint16_t temp_fg = display.foreground;
     display.background = TITLE_BOX_BG;
     display.foreground = TEXT_COL;
-    display_string_xy("Current Turn: ", 10, 7);
+    display_string_xy_P(PSTR("Current Turn: "), 10, 7);
     write_player(player);
 
     display.background = temp_bg;
@@ -119,7 +123,7 @@ void write_winner(uint8_t player) {
     uint16_t temp_fg = display.foreground;
     display.background = TITLE_BOX_BG;
     display.foreground = TEXT_COL;
-    display_string_xy("WINNER: ", 10, 7);
+    display_string_xy_P(PSTR("WINNER: "), 10, 7);
     write_player(player);
 
     display.background = temp_bg;
@@ -127,37 +131,38 @@ void write_winner(uint8_t player) {
 }
 
 void write_player(uint8_t player) {
-    char* str = "";
     switch (player) {
     case PLAYER_ONE:
-        str = PLAYER_ONE_STR_UP;
         display.foreground = PLAYER_ONE_COL;
+        display_string_P(PSTR("PLAYER " PLAYER_ONE_STR_UP));
         break;
     case PLAYER_TWO:
-        str = PLAYER_TWO_STR_UP;
         display.foreground = PLAYER_TWO_COL;
+        display_string_P(PSTR("PLAYER " PLAYER_TWO_STR_UP));
         break;
     }
-    display_string("PLAYER ");
-    display_string(str);
 }
 
-void generate_two_grid_view(draw_props_t* grid_1, draw_props_t* grid_2, double weight) {
+void generate_two_grid_view(draw_props_t* grid_1, draw_props_t* grid_2, uint8_t weight_num, uint8_t weight_den) {
     uint16_t middle_split = 10;
     uint16_t draw_width = draw_area.right - draw_area.left - middle_split;
     uint16_t draw_height = draw_area.bottom - draw_area.top;
 
     // Create Grid 1 (aligned left)
-    grid_1->width = draw_width * weight;
+    grid_1->width = draw_width * weight_num / weight_den;
     grid_1->height = grid_1->width;
     grid_1->x = draw_area.left,
             grid_1->y = header.bottom + (draw_height - grid_1->height + TITLE_HEIGHT) / 2;
 
     // Create Grid 2 (aligned right)
-    grid_2->width = draw_width * (1 - weight);
+    grid_2->width = draw_width * (weight_den - weight_num) / weight_den;
     grid_2->height = grid_2->width;
     grid_2->x = draw_area.right - grid_2->width;
     grid_2->y = header.bottom + (draw_height - grid_2->height + TITLE_HEIGHT) / 2;
+
+    // Nothing has been drawn in the new views
+    reset_view(grid_1);
+    reset_view(grid_2);
 }
 
 
@@ -165,19 +170,40 @@ void generate_one_grid_view(draw_props_t* grid) {
     uint16_t draw_height = draw_area.bottom - draw_area.top;
 
     // Create Grid 1 (aligned left)
-    grid->width = draw_height * 0.8;
+    grid->width = draw_height * 4 / 5;
     grid->height = grid->width;
     grid->x = (draw_area.right - grid->width) / 2;
     grid->y = draw_area.top + (draw_height - grid->height + TITLE_HEIGHT) / 2;
+    reset_view(grid);
 }
 
 void draw_centred_string(char* text, rectangle* rec) {
-    uint8_t len = strlen(text);
+    position_centred_string(text, false, rec);
+    display_string_xy(text, display.x, display.y);
+}
+
+
+void draw_centred_string_P(PGM_P text, rectangle* rec) {
+    position_centred_string(text, true, rec);
+    display_string_xy_P(text, display.x, display.y);
+}
+
+
+/**
+ * Move the display position to where a string should start to be central to a rectangle.
+ *
+ * @param text  Text that will be drawn
+ * @param flash Whether the text is in program memory
+ * @param rec   Rectangle to use for positioning
+ */
+void position_centred_string(const char* text, bool flash, rectangle* rec) {
     uint8_t text_width = 0;
     uint8_t line_width = 0;
     uint8_t text_height = FONT_HEIGHT;
-    for (uint8_t i=0; i < len; i++) {
-        if (text[i] == '\n') {
+    char c;
+    while ((c = flash ? pgm_read_byte(text) : *text)) {
+        text++;
+        if (c == '\n') {
             if (line_width > text_width) {
                 text_width = line_width;
             }
@@ -193,5 +219,17 @@ void draw_centred_string(char* text, rectangle* rec) {
 
     display.x = rec->left + (rec->right - rec->left - text_width) / 2;
     display.y = rec->top + (rec->bottom - rec->top - text_height) / 2;
-    display_string_xy(text, display.x, display.y);
-}
\ No newline at end of file
+}
+
+
+/**
+ * Forget what has been drawn in a view: its shot changes, damage and selection.
+ *
+ * @param view Drawing properties of the view
+ */
+void reset_view(draw_props_t* view) {
+    view->shots.grid = NULL;
+    bb_clear(&view->damage);
+    view->sel_x = NO_SELECTION;
+    view->sel_y = NO_SELECTION;
+}
@@ -74,8 +74,18 @@ void draw_footer();
 void write_current_player(uint8_t player);
 void write_winner(uint8_t player);
 void write_player(uint8_t player);
-void write_current_turn(uint8_t turn);
-void generate_two_grid_view(draw_props_t* grid_1, draw_props_t* grid_2, double weight);
+void write_current_turn(uint16_t turn);
+
+/**
+ * Generate side by side views for two grids in the draw area. The left grid takes weight_num/weight_den
+ * of the width and the right grid the rest. The width times weight_den must fit in 16 bits.
+ *
+ * @param grid_1     View for the left grid
+ * @param grid_2     View for the right grid
+ * @param weight_num Numerator of the left grid's share of the width
+ * @param weight_den Denominator of the left grid's share of the width
+ */
+void generate_two_grid_view(draw_props_t* grid_1, draw_props_t* grid_2, uint8_t weight_num, uint8_t weight_den);
 
 void generate_one_grid_view(draw_props_t* grid);
 
@@ -87,4 +97,11 @@ void generate_one_grid_view(draw_props_t* grid);
  */
 void draw_centred_string(char* text, rectangle* rec);
 
+/**
+ * Draw a string held in program memory central to a given rectangle, as draw_centred_string.
+ * @param text Text to draw
+ * @param rec  Rectangle to use for positioning
+ */
+void draw_centred_string_P(PGM_P text, rectangle* rec);
+
 #endif // UI_DRAWING_H
\ No newline at end of file